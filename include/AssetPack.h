@@ -0,0 +1,93 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// On-disk layout of a .pak file, all integers little-endian:
+//   AssetPackHeader
+//   AssetPackEntry[entryCount]   sorted by nameHash
+//   name strings                 entry names, not NUL-terminated
+//   blobs                        each starting on a 4 KB boundary
+const char ASSET_PACK_MAGIC[8] = { 'L', 'O', 'G', 'L', 'P', 'A', 'K', '\0' };
+const std::uint32_t ASSET_PACK_VERSION = 1;
+const std::uint64_t ASSET_PACK_ALIGNMENT = 4096;
+
+struct AssetPackHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint64_t tocOffset;
+    std::uint64_t namesOffset;
+    std::uint64_t namesSize;
+};
+
+struct AssetPackEntry
+{
+    std::uint64_t nameHash; // fnv1a64 of the name
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t nameOffset; // relative to namesOffset
+    std::uint32_t nameLength;
+};
+
+// the tables are mapped and read in place, so their layout must not depend on the compiler
+static_assert(sizeof(AssetPackHeader) == 40, "AssetPackHeader layout changed");
+static_assert(sizeof(AssetPackEntry) == 32, "AssetPackEntry layout changed");
+
+// a view into the mapped pack. Valid for as long as the AssetPack it came from stays open.
+struct AssetBlob
+{
+    const unsigned char* data = nullptr;
+    std::size_t size = 0;
+
+    explicit operator bool() const { return data != nullptr; }
+    const char* chars() const { return reinterpret_cast<const char*>(data); }
+};
+
+// read side: maps the whole pack once and hands out pointers straight into the mapping, so decoders and GL uploads read
+// the bytes without any intermediate copy
+class AssetPack
+{
+public:
+    AssetPack();
+    explicit AssetPack(const std::string& path);
+
+    bool open(const std::string& path);
+    bool isOpen() const { return file.isOpen(); }
+    // look an asset up by the name it was packed under, e.g. "assets/container.jpg". Returns an empty blob if it isn't in the pack.
+    AssetBlob find(const std::string& name) const;
+    std::size_t size() const { return count; }
+
+private:
+    MappedFile file;
+    const AssetPackEntry* entries;
+    const char* names;
+    std::size_t count;
+};
+
+// write side, used by the packer: collects files and writes them out as one pack
+class AssetPackWriter
+{
+public:
+    // queue a file on disk, packed under its path as given (with '\\' turned into '/')
+    void addFile(const std::string& path);
+    // queue a file on disk under a different name
+    void addFile(const std::string& path, const std::string& name);
+    bool write(const std::string& outputPath) const;
+
+private:
+    struct Source
+    {
+        std::string path;
+        std::string name;
+    };
+    std::vector<Source> sources;
+};
+
+#endif
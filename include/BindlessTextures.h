@@ -0,0 +1,76 @@
+#ifndef BINDLESS_TEXTURES_H
+#define BINDLESS_TEXTURES_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "TextureCache.h"
+
+// ARB_bindless_texture isn't part of the GL 3.3 core loader, so its entry points are fetched here
+namespace bindless
+{
+    // fetch the extension's entry points with the same loader glad was initialised with. Returns false if the extension isn't available,
+    // in which case callers fall back to texture arrays or classic binds.
+    bool load(GLADloadproc loader);
+    bool isSupported();
+}
+
+// maps material IDs to resident bindless texture handles stored in a uniform buffer, so shaders sample any material
+// without a single glBindTexture per draw. Residency is kept under a byte budget: materials that aren't requested for a while
+// are made non-resident and their slot points at the fallback texture until they're requested again. Slots may share a texture
+// (the fallback is often also a material), so residency is counted per handle and a handle is only made non-resident, and its
+// bytes released, once no slot holds it.
+class BindlessTextureTable
+{
+public:
+    // 1024 handles keep the block at 8 KB, inside the 16 KB GL_MAX_UNIFORM_BLOCK_SIZE every implementation guarantees
+    static constexpr std::size_t MAX_MATERIALS = 1024;
+
+    // fallback is sampled by materials that aren't resident and is itself always resident
+    BindlessTextureTable(const TextureHandle& fallback, std::size_t residentBudgetBytes = 512u * 1024u * 1024u);
+    ~BindlessTextureTable();
+    BindlessTextureTable(const BindlessTextureTable&) = delete;
+    BindlessTextureTable& operator=(const BindlessTextureTable&) = delete;
+
+    // register a texture and return its material ID, or -1 if the table is full. The table keeps a reference so the texture outlives its handle.
+    int addMaterial(const TextureHandle& texture);
+    // mark a material as used this frame, making it resident if it was evicted; eviction itself only happens in beginFrame
+    void request(int material);
+    // start a new frame: materials not requested for more than keepFrames frames become candidates for eviction
+    void beginFrame(std::uint64_t keepFrames = 3);
+    // push changed handles to the uniform buffer and bind it to the given uniform block binding point
+    void bind(unsigned int bindingPoint);
+
+    std::size_t residentBytes() const { return bytesResident; }
+    std::size_t materialCount() const { return materials.size(); }
+
+private:
+    struct Slot
+    {
+        TextureHandle texture;
+        GLuint64 handle = 0;
+        std::size_t bytes = 0;
+        std::uint64_t lastRequested = 0;
+        bool resident = false;
+    };
+
+    void makeResident(Slot& slot);
+    void makeNonResident(Slot& slot);
+    void writeHandle(std::size_t material);
+
+    Slot fallbackSlot;
+    std::unordered_map<GLuint64, int> residentCounts; // slots currently holding each handle resident
+    std::vector<Slot> materials;
+    std::vector<GLuint64> handles; // mirrors the uniform buffer contents
+    unsigned int UBO;
+    bool dirty;
+    std::size_t budget;
+    std::size_t bytesResident;
+    std::uint64_t frame;
+};
+
+#endif
@@ -2,10 +2,14 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
+#include <cstdint>
+
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "Frustum.h"
+
 // Defines several possible options for camera movement. Used as abstraction to stay away from window-system specific input methods
 enum Camera_Movement {
     FORWARD,
@@ -20,9 +24,15 @@ const float PITCH = 0.0f;
 const float SPEED = 2.5f;
 const float SENSITIVITY = 0.1f;
 const float ZOOM = 45.0f;
+const float ASPECT = 800.0f / 600.0f;
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
 
 
-// An abstract camera class that processes input and calculates the corresponding Euler Angles, Vectors and Matrices for use in OpenGL
+// An abstract camera class that processes input and calculates the corresponding Euler Angles, Vectors and Matrices for use in OpenGL.
+// The matrices and frustum are cached: every getter first compares the inputs they were built from (position, orientation, zoom,
+// aspect, clip planes) against the current ones and only rebuilds on a difference. Each rebuild bumps GetVersion(), so a caller
+// can remember the version it last saw and skip culling or uniform uploads while the camera is still.
 class Camera
 {
 public:
@@ -39,9 +49,13 @@ public:
     float MovementSpeed;
     float MouseSensitivity;
     float Zoom;
+    // projection options; change them through SetProjection
+    float Aspect;
+    float NearPlane;
+    float FarPlane;
 
     // constructor with vectors
-    Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM)
+    Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM), Aspect(ASPECT), NearPlane(NEAR_PLANE), FarPlane(FAR_PLANE), version(0), cacheValid(false)
     {
         Position = position;
         WorldUp = up;
@@ -50,7 +64,7 @@ public:
         updateCameraVectors();
     }
     // constructor with scalar values
-    Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM)
+    Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY), Zoom(ZOOM), Aspect(ASPECT), NearPlane(NEAR_PLANE), FarPlane(FAR_PLANE), version(0), cacheValid(false)
     {
         Position = glm::vec3(posX, posY, posZ);
         WorldUp = glm::vec3(upX, upY, upZ);
@@ -60,9 +74,46 @@ public:
     }
 
     // returns the view matrix calculated using Euler Angles and the LookAt Matrix
-    glm::mat4 GetViewMatrix()
+    const glm::mat4& GetViewMatrix()
+    {
+        refresh();
+        return view;
+    }
+    // perspective projection from Zoom (the vertical field of view, in degrees), Aspect and the clip planes
+    const glm::mat4& GetProjectionMatrix()
+    {
+        refresh();
+        return projection;
+    }
+    const glm::mat4& GetViewProjectionMatrix()
+    {
+        refresh();
+        return viewProjection;
+    }
+    // clip space back to world space, for unprojecting screen positions
+    const glm::mat4& GetInverseViewProjectionMatrix()
+    {
+        refresh();
+        return inverseViewProjection;
+    }
+    const Frustum& GetFrustum()
+    {
+        refresh();
+        return frustum;
+    }
+    // bumped every time the matrices above are rebuilt
+    std::uint64_t GetVersion()
+    {
+        refresh();
+        return version;
+    }
+
+    // call when the framebuffer is resized; a no-op when nothing changes
+    void SetProjection(float aspect, float nearPlane = NEAR_PLANE, float farPlane = FAR_PLANE)
     {
-        return glm::lookAt(Position, Position + Front, Up);
+        Aspect = aspect;
+        NearPlane = nearPlane;
+        FarPlane = farPlane;
     }
 
     // processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
@@ -101,6 +152,14 @@ public:
         updateCameraVectors();
     }
 
+    // points the camera at the given Euler angles directly, for scripted cameras
+    void SetOrientation(float yaw, float pitch)
+    {
+        Yaw = yaw;
+        Pitch = pitch;
+        updateCameraVectors();
+    }
+
     // processes input received from a mouse scroll-wheel event. Only requires input on the vertical wheel-axis
     void ProcessMouseScroll(float yoffset)
     {
@@ -112,6 +171,52 @@ public:
     }
 
 private:
+    // cached matrices, and the inputs they were built from
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::mat4 inverseViewProjection;
+    Frustum frustum;
+    std::uint64_t version;
+    bool cacheValid;
+    glm::vec3 cachedPosition;
+    glm::vec3 cachedFront;
+    glm::vec3 cachedUp;
+    float cachedZoom;
+    float cachedAspect;
+    float cachedNear;
+    float cachedFar;
+
+    // rebuilds the matrices if any input changed since last time. Comparing the inputs, rather than setting a flag in the Process*
+    // functions, also catches the public members being written directly.
+    void refresh()
+    {
+        const bool viewChanged = !cacheValid || Position != cachedPosition || Front != cachedFront || Up != cachedUp;
+        const bool projectionChanged = !cacheValid || Zoom != cachedZoom || Aspect != cachedAspect || NearPlane != cachedNear || FarPlane != cachedFar;
+        if (!viewChanged && !projectionChanged)
+            return;
+        if (viewChanged)
+        {
+            view = glm::lookAt(Position, Position + Front, Up);
+            cachedPosition = Position;
+            cachedFront = Front;
+            cachedUp = Up;
+        }
+        if (projectionChanged)
+        {
+            projection = glm::perspective(glm::radians(Zoom), Aspect, NearPlane, FarPlane);
+            cachedZoom = Zoom;
+            cachedAspect = Aspect;
+            cachedNear = NearPlane;
+            cachedFar = FarPlane;
+        }
+        viewProjection = projection * view;
+        inverseViewProjection = glm::inverse(viewProjection);
+        frustum.extract(viewProjection);
+        cacheValid = true;
+        version++;
+    }
+
     // calculates the front vector from the Camera's (updated) Euler Angles
     void updateCameraVectors()
     {
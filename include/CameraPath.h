@@ -0,0 +1,63 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// one keyframe of a camera path
+struct CameraKey
+{
+    float time; // seconds from the start of the path
+    glm::vec3 position;
+    float yaw;   // degrees, as in Camera
+    float pitch;
+    float zoom;
+};
+
+// an authored camera flythrough: keyframes joined by Catmull-Rom splines, so the camera passes through every key with a smooth
+// velocity. Keys may be unevenly spaced in time; each one's tangent is taken over its neighbours' time span, so speed stays
+// continuous across keys. A .path file is plain text, one key per line, '#' starting a comment:
+//   time  x y z  yaw pitch  zoom
+// Times must increase. Yaw is not wrapped, so a full turn is written as -90 ... 270 rather than jumping back to -90.
+class CameraPath
+{
+public:
+    bool load(const std::string& path);
+
+    bool empty() const { return keys.size() < 2; }
+    float duration() const { return keys.empty() ? 0.0f : keys.back().time - keys.front().time; }
+    // segment s runs from key s to key s + 1
+    std::size_t segmentCount() const { return keys.size() < 2 ? 0 : keys.size() - 1; }
+    const CameraKey& key(std::size_t index) const { return keys[index]; }
+
+    // the camera at `time` seconds from the start, clamped to the path; returns the segment it falls in
+    std::size_t sample(float time, CameraKey& out) const;
+
+private:
+    std::vector<CameraKey> keys;
+};
+
+// frame times gathered per path segment, so a flythrough shows which stretch of the scene is expensive
+class CameraPathStats
+{
+public:
+    void reset(std::size_t segments);
+    void addFrame(std::size_t segment, double milliseconds, std::size_t draws);
+    void report(const CameraPath& path) const;
+
+private:
+    struct Segment
+    {
+        std::uint64_t frames = 0;
+        double totalMilliseconds = 0.0;
+        double maxMilliseconds = 0.0;
+        std::uint64_t draws = 0;
+    };
+    std::vector<Segment> segments;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef CLUSTER_CULLER_H
+#define CLUSTER_CULLER_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Frustum.h"
+#include "MeshFormat.h"
+
+struct ClusterCullStats
+{
+    std::size_t tested = 0;
+    std::size_t frustumCulled = 0;
+    std::size_t backfaceCulled = 0;
+    std::size_t visible = 0;
+    std::size_t trianglesVisible = 0;
+    std::size_t draws = 0; // ranges after merging neighbouring visible meshlets
+};
+
+// per-object CPU culling of a mesh's meshlets against the view frustum and their normal cones. The surviving meshlets come out as
+// index ranges ready for one glMultiDrawElements call; meshlets that are next to each other in the index buffer are merged into
+// one range so a mostly visible mesh doesn't turn into hundreds of tiny draws.
+class ClusterCuller
+{
+public:
+    // model may rotate, translate and scale uniformly; with a non-uniform scale only the frustum test is applied.
+    // firstIndex/baseVertex place the mesh inside shared buffers (see Mesh::firstIndex, GeometryPool).
+    void cull(const std::vector<Meshlet>& meshlets, const glm::mat4& model, const Frustum& frustum, const glm::vec3& eye,
+        std::size_t indexSize, std::uint32_t firstIndex = 0, GLint baseVertex = 0);
+
+    const std::vector<GLsizei>& counts() const { return drawCounts; }
+    const std::vector<const void*>& offsets() const { return drawOffsets; }
+    const std::vector<GLint>& baseVertices() const { return drawBaseVertices; }
+    GLsizei drawCount() const { return static_cast<GLsizei>(drawCounts.size()); }
+    // totals since the last resetStats, summed over every cull call
+    const ClusterCullStats& stats() const { return totals; }
+    void resetStats() { totals = ClusterCullStats(); }
+
+private:
+    std::vector<GLsizei> drawCounts;
+    std::vector<const void*> drawOffsets;
+    std::vector<GLint> drawBaseVertices;
+    ClusterCullStats totals;
+};
+
+#endif
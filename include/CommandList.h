@@ -0,0 +1,97 @@
+#ifndef COMMAND_LIST_H
+#define COMMAND_LIST_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+enum CommandType : std::uint16_t
+{
+    COMMAND_BIND_VERTEX_ARRAY,
+    COMMAND_USE_PROGRAM,
+    COMMAND_BIND_TEXTURE,
+    COMMAND_UNIFORM_MAT4,
+    COMMAND_UNIFORM_VEC3,
+    COMMAND_UNIFORM_VEC4,
+    COMMAND_UNIFORM_INT,
+    COMMAND_DRAW_ARRAYS,
+    COMMAND_DRAW_ELEMENTS,
+    COMMAND_MULTI_DRAW_ELEMENTS
+};
+
+// every command starts with this; size covers the header, the command and any trailing arrays, rounded to 8 bytes
+struct CommandHeader
+{
+    CommandType type;
+    std::uint16_t reserved;
+    std::uint32_t size;
+};
+
+// a recorded stream of plain-data render commands in one growing byte arena. Recording touches no GL state at all, so any thread
+// can fill a list; only execution (CommandExecutor) needs the context. reset() keeps the memory, so after the first few frames
+// recording never allocates. Uniforms are set by location, which has to be looked up on the GL thread beforehand.
+class CommandList
+{
+public:
+    explicit CommandList(std::size_t reserveBytes = 64 * 1024);
+
+    void reset() { used = 0; commandCount = 0; }
+    bool empty() const { return commandCount == 0; }
+    std::size_t size() const { return commandCount; }
+    std::size_t bytes() const { return used; }
+
+    void bindVertexArray(unsigned int vao);
+    void useProgram(unsigned int program);
+    void bindTexture(unsigned int unit, GLenum target, unsigned int texture);
+    void setMat4(GLint location, const glm::mat4& value);
+    void setVec3(GLint location, const glm::vec3& value);
+    void setVec4(GLint location, const glm::vec4& value);
+    void setInt(GLint location, int value);
+    void drawArrays(GLenum mode, GLint first, GLsizei count, GLsizei instances = 1);
+    // offset in bytes into the bound element buffer, as for glDrawElements
+    void drawElements(GLenum mode, GLsizei count, GLenum indexType, std::size_t offset, GLint baseVertex = 0, GLsizei instances = 1);
+    void multiDrawElements(GLenum mode, GLenum indexType, const GLsizei* counts, const void* const* offsets, const GLint* baseVertices, GLsizei drawCount);
+
+    // walk the recorded commands: data() points at the first header, each header's size leads to the next
+    const unsigned char* data() const { return arena.data(); }
+
+private:
+    void* allocate(CommandType type, std::size_t size);
+
+    std::vector<unsigned char> arena;
+    std::size_t used;
+    std::size_t commandCount;
+};
+
+// GL backend: replays command lists on the context thread, dropping binds that wouldn't change anything
+class CommandExecutor
+{
+public:
+    CommandExecutor();
+
+    // forget the cached bindings; call when other code may have touched GL state since the last execute
+    void invalidate();
+    void execute(const CommandList& list);
+
+    std::size_t commandsExecuted() const { return executed; }
+    std::size_t commandsSkipped() const { return skipped; }
+    std::size_t drawCalls() const { return draws; }
+    void resetCounters() { executed = skipped = draws = 0; }
+
+private:
+    static const int MAX_TEXTURE_UNITS = 16;
+
+    unsigned int vertexArray;
+    unsigned int program;
+    unsigned int textures[MAX_TEXTURE_UNITS];
+    std::vector<const void*> offsetScratch; // multi-draw offsets widened back to pointers; kept between lists so it stops allocating
+    std::size_t executed;
+    std::size_t skipped;
+    std::size_t draws;
+};
+
+#endif
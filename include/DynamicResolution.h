@@ -0,0 +1,65 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+// renders the scene into an offscreen colour+depth target whose size follows the GPU's frame time, then stretches it over the
+// window with a linear blit. The target is allocated once at the largest scale and only the viewport shrinks, so changing the
+// scale never reallocates. GPU time comes from GL_TIME_ELAPSED queries in a small ring, read back a few frames late so the
+// render thread never waits for the GPU. The scale is steered towards the target time: pixel cost grows with the square of the
+// scale, so each adjustment moves it by the square root of target/measured, damped, and the measurement is smoothed so single
+// spikes don't make the resolution pump.
+//
+// Create, use and destroy it on the thread that owns the GL context.
+class DynamicResolution
+{
+public:
+    DynamicResolution(double targetMilliseconds, float minScale, float maxScale);
+    ~DynamicResolution();
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // size of the window's framebuffer, which the scene is upscaled to; reallocates the target when it changes
+    void setOutputSize(int width, int height);
+    // bind the target and set the viewport to the scaled size; the frame's draws go between begin and end
+    void begin();
+    // stop timing, blit to the default framebuffer and restore the full viewport; then pick next frame's scale from what has finished
+    void end();
+
+    float scale() const { return currentScale; }
+    int renderWidth() const;
+    int renderHeight() const;
+    // smoothed GPU time of the scene pass
+    double gpuMilliseconds() const { return smoothedMilliseconds; }
+    void report() const;
+
+private:
+    static const int QUERY_COUNT = 4;
+
+    void adjust(double milliseconds);
+
+    double targetMilliseconds;
+    float minScale;
+    float maxScale;
+    float currentScale;
+    double smoothedMilliseconds;
+
+    int outputWidth;
+    int outputHeight;
+    unsigned int framebuffer;
+    unsigned int colorTexture;
+    unsigned int depthBuffer;
+
+    unsigned int queries[QUERY_COUNT];
+    std::uint64_t issued;   // queries begun so far
+    std::uint64_t resolved; // queries read back so far
+
+    // for report()
+    std::uint64_t frames;
+    double scaleSum;
+    double millisecondsSum;
+};
+
+#endif
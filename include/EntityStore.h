@@ -0,0 +1,117 @@
+#ifndef ENTITY_STORE_H
+#define ENTITY_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "Frustum.h"
+
+class JobSystem;
+
+// handle to an entity. The generation tells a destroyed entity's handle apart from a newer one that reuses its index.
+struct Entity
+{
+    std::uint32_t index;
+    std::uint32_t generation;
+
+    bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+const Entity NO_ENTITY = { 0xFFFFFFFFu, 0 };
+const std::uint32_t NO_ROW = 0xFFFFFFFFu;
+
+// scene objects stored as structure-of-arrays: every component is its own densely packed array, all indexed by the same row, so
+// a system that only needs positions and bounds streams through just those arrays. Every scene object has the same set of
+// components (one archetype), so there is one table. Rows move, handles don't: go through row() to find an entity's data.
+//
+// Entities form a transform hierarchy. Rows are kept sorted by depth in the tree, so every parent comes before its children and
+// each depth is one contiguous level. Changing a local transform only sets a dirty bit; updateTransforms then walks the levels
+// in order, recomputing world matrices just for dirty rows and rows whose parent changed, and does nothing at all when no bit is
+// set. Rows within a level don't depend on each other, so each level is split across the job system.
+class EntityStore
+{
+public:
+    EntityStore();
+
+    Entity create(Entity parent = NO_ENTITY);
+    // children of a destroyed entity become roots, keeping their local transforms
+    void destroy(Entity entity);
+    bool alive(Entity entity) const;
+    void clear();
+    void reserve(std::size_t entities);
+
+    // NO_ENTITY makes it a root. Refuses (and returns false) if parent is the entity itself or one of its descendants.
+    bool setParent(Entity child, Entity parent);
+    Entity parent(Entity entity) const;
+
+    // number of live entities, i.e. rows
+    std::size_t size() const { return entities.size(); }
+    // one more than the highest entity index ever handed out: the size for per-entity arrays indexed by Entity::index
+    std::size_t indexCount() const { return rows.size(); }
+    // the entity's row, or NO_ROW for a destroyed (stale) handle
+    std::size_t row(Entity entity) const { return alive(entity) ? rows[entity.index] : NO_ROW; }
+    Entity entity(std::size_t row) const { return entities[row]; }
+
+    // local transform (relative to the parent) and object-space bounding sphere (xyz centre, w radius)
+    void setPosition(Entity entity, const glm::vec3& position);
+    void setRotation(Entity entity, const glm::quat& rotation);
+    void setScale(Entity entity, const glm::vec3& scale);
+    void setLocalBounds(Entity entity, const glm::vec4& sphere);
+
+    // components, all size() long and indexed by row; valid until the next create/destroy/setParent/updateTransforms
+    const glm::vec3* positions() const { return positionData.data(); }
+    const glm::quat* rotations() const { return rotationData.data(); }
+    const glm::vec3* scales() const { return scaleData.data(); }
+    const glm::vec4* localBounds() const { return localBoundsData.data(); }
+    std::uint32_t* meshIds() { return meshIdData.data(); }
+    std::uint32_t* materialIds() { return materialIdData.data(); }
+    const glm::mat4* worldMatrices() const { return worldData.data(); }
+    const glm::vec4* worldBounds() const { return worldBoundsData.data(); }
+    // written by cull: 1 if the row's world bounds touch the frustum
+    const std::uint8_t* visibility() const { return visibleData.data(); }
+
+    // systems
+    // -------
+    // bring world matrices and world bounds up to date; returns how many rows were recomputed
+    std::size_t updateTransforms(JobSystem& jobs);
+    // frustum test of the world bounds over rows [begin, end); returns how many are visible
+    std::size_t cull(const Frustum& frustum, std::size_t begin, std::size_t end);
+
+private:
+    void markDirty(Entity entity);
+    // restore parents-before-children order after a structural change and rebuild the level table
+    void sortByDepth();
+    std::size_t updateRows(std::size_t begin, std::size_t end);
+    void updateBounds(std::size_t row);
+
+    // per row
+    std::vector<glm::vec3> positionData;
+    std::vector<glm::quat> rotationData;
+    std::vector<glm::vec3> scaleData;
+    std::vector<glm::vec4> localBoundsData;
+    std::vector<std::uint32_t> meshIdData;
+    std::vector<std::uint32_t> materialIdData;
+    std::vector<glm::mat4> worldData;
+    std::vector<glm::vec4> worldBoundsData;
+    std::vector<std::uint8_t> visibleData;
+    std::vector<std::uint32_t> parentRows; // NO_ROW for roots
+    std::vector<std::uint8_t> dirty;       // local transform changed since the last update
+    std::vector<std::uint8_t> changed;     // world matrix recomputed in the current update, read by the children
+    std::vector<Entity> entities;          // row -> entity
+
+    // per entity index
+    std::vector<std::uint32_t> rows;
+    std::vector<std::uint32_t> generations;
+    std::vector<std::uint32_t> freeIndices;
+
+    std::vector<std::size_t> levelStarts; // rows of depth d are [levelStarts[d], levelStarts[d + 1])
+    bool orderValid;
+    bool anyDirty;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// bump allocator for memory that only lives for a frame. Allocating is a pointer increment and nothing is freed individually:
+// beginFrame() starts over. There are two buffers used alternately, so what frame N allocated stays valid through frame N+1,
+// while the other thread (or the GPU) may still be reading it.
+//
+// A frame that outgrows its buffer spills into the heap; the next time that buffer comes round it's resized to fit, so after a
+// few frames of warm-up the arena never allocates. One arena per thread, it isn't synchronised.
+class FrameArena
+{
+public:
+    explicit FrameArena(std::size_t bytesPerFrame = 1024 * 1024);
+    ~FrameArena();
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // switch to the other buffer and forget everything allocated from it two frames ago
+    void beginFrame();
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+    template <typename T>
+    T* allocateArray(std::size_t count) { return static_cast<T*>(allocate(count * sizeof(T), alignof(T))); }
+
+    // bytes handed out this frame, including any that spilled to the heap
+    std::size_t used() const;
+    std::size_t capacity() const { return buffers[current].memory.size(); }
+    // the most any frame has used, and how many allocations didn't fit their buffer
+    std::size_t peak() const { return peakBytes; }
+    std::size_t overflows() const { return overflowCount; }
+    // debug: print a line whenever a frame sets a new peak, to size the arena by
+    void setReportPeaks(bool report) { reportPeaks = report; }
+
+private:
+    struct Buffer
+    {
+        std::vector<unsigned char> memory;
+        std::size_t used = 0;
+        std::vector<void*> spilled; // heap blocks for allocations that didn't fit
+        std::size_t spilledBytes = 0;
+    };
+
+    Buffer buffers[2];
+    int current;
+    std::size_t peakBytes;
+    std::size_t overflowCount;
+    bool reportPeaks;
+};
+
+// std::allocator stand-in that draws from a FrameArena, e.g. std::vector<int, FrameAllocator<int>>. deallocate does nothing;
+// the memory comes back at the arena's next turn on that buffer, so containers must not outlive it.
+template <typename T>
+class FrameAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit FrameAllocator(FrameArena& arena) : arena(&arena) {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(std::size_t count) { return arena->allocateArray<T>(count); }
+    void deallocate(T*, std::size_t) {}
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+    template <typename U>
+    friend class FrameAllocator;
+    FrameArena* arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef FRAME_CLOCK_H
+#define FRAME_CLOCK_H
+
+#include <cstdint>
+
+// fixed-timestep clock. Each frame's real duration is added to an accumulator, which is drained in whole steps of a fixed size;
+// the simulation runs once per step, so it sees the same step sequence at 30 fps as at 300 and gives the same results. Whatever is
+// left over is alpha(): how far real time has got into the next step, used to blend the last two simulation states for drawing.
+// A frame that takes longer than maxSteps steps (a breakpoint, a hitch) only runs maxSteps and drops the rest, so one slow frame
+// can't leave the simulation permanently behind.
+class FrameClock
+{
+public:
+    explicit FrameClock(double stepSeconds = 1.0 / 60.0, int maxSteps = 8);
+
+    // add a frame's worth of real time; returns how many steps to simulate now
+    int advance(double frameSeconds);
+
+    double step() const { return stepSeconds; }
+    // in [0, 1): 0 draws the latest step's state, values towards 1 blend in more of the time until the next
+    double alpha() const { return accumulator / stepSeconds; }
+    // simulation time at the latest step
+    double time() const { return static_cast<double>(steps) * stepSeconds; }
+    // simulation time matching alpha(), between the last two steps
+    double interpolatedTime() const;
+    std::uint64_t stepCount() const { return steps; }
+    // seconds of real time thrown away by the maxSteps limit
+    double droppedTime() const { return dropped; }
+
+private:
+    double stepSeconds;
+    int maxSteps;
+    double accumulator;
+    std::uint64_t steps;
+    double dropped;
+};
+
+#endif
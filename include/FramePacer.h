@@ -0,0 +1,58 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum PresentMode
+{
+    PRESENT_VSYNC,    // swap interval 1: never tears, but a late frame waits a whole refresh
+    PRESENT_ADAPTIVE, // swap interval -1: synced while on time, tears instead of waiting when late (falls back to vsync)
+    PRESENT_UNCAPPED, // swap interval 0, no limit: lowest latency, most power
+    PRESENT_CAPPED    // swap interval 0, paced by the CPU to a target frame rate
+};
+
+// chooses how frames are presented and measures the result. The capped mode sleeps until shortly before each frame's deadline and
+// spins the rest of the way, because OS sleeps overshoot by up to a scheduler tick; the wait happens before input is sampled, so
+// the frame it delays is built from the freshest input. Latency is timed from the input sample that fed a frame to the return of
+// its swap, which is the part of input latency the application controls (scan-out and the display come after).
+class FramePacer
+{
+public:
+    FramePacer();
+
+    // "vsync", "adaptive", "uncapped", or a frame rate to cap to
+    bool parse(const char* mode);
+    PresentMode mode() const { return presentMode; }
+    const char* name() const;
+
+    // set the swap interval of the context that is current on this thread
+    void apply();
+    // capped mode: block until the next frame is due. Call once per frame before sampling input
+    void wait();
+
+    // after a swap returns: inputTime is when the input for the swapped frame was sampled (glfwGetTime)
+    void recordSwap(double inputTime);
+    void report() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    PresentMode presentMode;
+    double targetRate; // frames per second, capped mode only
+    Clock::time_point deadline;
+    bool pacing;
+
+    // measurements, written by whichever thread swaps. The rings keep the most recent frames for percentiles and are allocated up
+    // front, so measuring doesn't show up in the benchmark's allocation count; the totals cover every frame
+    std::vector<float> latencies;      // milliseconds
+    std::vector<float> frameIntervals; // milliseconds between consecutive swaps
+    std::uint64_t swaps;
+    double latencySum;
+    double latencyMax;
+    double lastSwap;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef FRAME_PACKET_H
+#define FRAME_PACKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Frustum.h"
+
+// one object the simulation wants drawn this frame
+struct DrawItem
+{
+    glm::mat4 model;
+    glm::vec3 position; // world-space centre, for LOD selection and culling
+    std::uint32_t object; // stable id (entity index) for state kept per object across frames, such as the current LOD
+    std::uint32_t mesh;     // SCENE_MESH_CUBE or SCENE_MESH_LOADED
+    std::uint32_t material; // index into the renderer's material table
+};
+
+// everything the render thread needs to draw one frame, produced by the simulation thread. The renderer never reads simulation
+// state directly, so the simulation can get on with the next frame while this one is being drawn.
+struct FramePacket
+{
+    std::uint64_t frame = 0;
+    float time = 0.0f;
+    double inputTime = 0.0; // glfwGetTime() when the input this frame was built from was sampled, for latency measurement
+    int framebufferWidth = 0;
+    int framebufferHeight = 0;
+    // camera
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    Frustum frustum;
+    std::uint64_t cameraVersion = 0; // Camera::GetVersion(); unchanged from the last packet means view and projection are too
+    glm::vec3 eye = glm::vec3(0.0f);
+    float fovy = 0.0f; // radians
+    std::size_t objectCount = 0; // upper bound on DrawItem::object
+    std::vector<DrawItem> draws; // only the objects that survived frustum culling
+};
+
+#endif
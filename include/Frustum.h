@@ -0,0 +1,40 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "glm/glm.hpp"
+
+// the six clip planes of a view-projection matrix (Gribb/Hartmann), normalized so plane distances are in world units.
+// Plane normals point inwards: a point p is inside when dot(plane.xyz, p) + plane.w >= 0 for every plane.
+struct Frustum
+{
+    glm::vec4 planes[6]; // left, right, bottom, top, near, far
+
+    Frustum() {}
+    explicit Frustum(const glm::mat4& viewProjection) { extract(viewProjection); }
+
+    void extract(const glm::mat4& m)
+    {
+        // glm is column-major, so row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+        for (int i = 0; i < 3; i++)
+        {
+            glm::vec4 row = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+            glm::vec4 w = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+            planes[i * 2] = w + row;
+            planes[i * 2 + 1] = w - row;
+        }
+        for (glm::vec4& plane : planes)
+            plane = plane / glm::length(glm::vec3(plane.x, plane.y, plane.z));
+    }
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const
+    {
+        for (const glm::vec4& plane : planes)
+        {
+            if (glm::dot(glm::vec3(plane.x, plane.y, plane.z), center) + plane.w < -radius)
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef GEOMETRY_POOL_H
+#define GEOMETRY_POOL_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "TlsfAllocator.h"
+#include "VertexLayout.h"
+
+// where one geometry lives inside the pool's shared buffers, in the units glDrawElementsBaseVertex wants
+struct GeometryRange
+{
+    GLint baseVertex = 0;          // added to every index, so the geometry's own 0-based indices are stored unchanged
+    std::uint32_t firstIndex = 0;  // in indices, not bytes
+    std::uint32_t vertexCount = 0;
+    std::uint32_t indexCount = 0;
+};
+
+struct GeometryPoolStats
+{
+    TlsfStats vertices; // bytes
+    TlsfStats indices;  // indices
+    std::size_t geometries = 0;
+    std::size_t relocations = 0; // defragment or grow passes so far
+    std::size_t bytesMoved = 0;
+};
+
+// many meshes packed into one vertex buffer and one index buffer, carved up with TLSF allocators. Geometries with the same vertex
+// layout share a VAO, so a whole scene of them draws without a single buffer or VAO switch. Vertex blocks are aligned to their
+// stride so baseVertex can address them; meshes with different layouts share the buffer but get one VAO per layout.
+// Geometries are referred to by id rather than by offset: defragment() and growing move them around.
+class GeometryPool
+{
+public:
+    GeometryPool(std::size_t vertexBytes = 64u * 1024u * 1024u, std::size_t indexCount = 16u * 1024u * 1024u, GLenum indexType = GL_UNSIGNED_INT);
+    ~GeometryPool();
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    // copy a geometry in, widening 16-bit source indices if the pool uses 32-bit ones. Returns its id, or -1 if it can't fit
+    // even after compacting and growing (or its indices can't be represented).
+    int add(const void* vertices, std::size_t vertexCount, const VertexLayout& layout, const void* indices, std::size_t indexCount, std::size_t sourceIndexSize);
+    void remove(int id);
+    const GeometryRange& range(int id) const { return geometries[id].range; }
+
+    // the VAO for geometries of this layout, created on first use
+    unsigned int vertexArray(const VertexLayout& layout);
+    GLenum indexType() const { return elementType; }
+    std::size_t indexSize() const { return elementType == GL_UNSIGNED_SHORT ? 2 : 4; }
+
+    // pack every live geometry to the front of new buffers, removing the holes left by remove()
+    void defragment() { relocate(vertexAllocator.capacity(), indexAllocator.capacity()); }
+    GeometryPoolStats stats() const;
+    // print occupancy and fragmentation of both buffers
+    void report() const;
+
+private:
+    struct Geometry
+    {
+        TlsfAllocation vertexBlock;
+        TlsfAllocation indexBlock;
+        GeometryRange range;
+        std::uint32_t stride = 0;
+        bool live = false;
+    };
+
+    struct LayoutArray
+    {
+        unsigned int VAO;
+        VertexLayout layout;
+    };
+
+    bool reserve(std::uint32_t vertexBytes, std::uint32_t stride, std::uint32_t indexCount, Geometry& geometry);
+    void relocate(std::uint32_t vertexCapacity, std::uint32_t indexCapacity);
+    void bindArray(const LayoutArray& array) const;
+    void updateRange(Geometry& geometry) const;
+
+    TlsfAllocator vertexAllocator;
+    TlsfAllocator indexAllocator;
+    unsigned int vertexBuffer;
+    unsigned int indexBuffer;
+    GLenum elementType;
+    std::vector<Geometry> geometries;
+    std::vector<int> freeIds;
+    std::map<std::uint32_t, LayoutArray> arrays; // keyed by VertexLayout::packFormats
+    std::size_t relocations;
+    std::size_t bytesMoved;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// 64-bit FNV-1a. Not cryptographic, only used to key caches and lookup tables.
+constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+inline std::uint64_t fnv1a64(const void* data, std::size_t size, std::uint64_t hash = FNV_OFFSET_BASIS)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// same hash over text, usable in constant expressions so names known at compile time cost nothing to hash
+constexpr std::uint64_t fnv1a64Text(std::string_view text, std::uint64_t hash = FNV_OFFSET_BASIS)
+{
+    for (char c : text)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef HEAP_COUNTER_H
+#define HEAP_COUNTER_H
+
+#include <cstdint>
+
+// counts calls to the global operator new (HeapCounter.cpp replaces it for the whole program). The count is a relaxed atomic
+// increment, cheap enough to leave on; --benchmark reads it to check that steady-state frames don't allocate. Memory the C
+// libraries malloc behind our back (GLFW, the driver, stb) isn't seen.
+namespace heapcounter
+{
+    std::uint64_t allocations();
+    std::uint64_t bytesAllocated();
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// On-disk layout of a .input recording, all integers little-endian:
+//   InputLogHeader
+//   per frame: InputFrameHeader, then InputEvent[eventCount]
+// A frame is what the camera saw between two processInput calls: the mouse and scroll events that arrived, in order, then the
+// movement keys held when the frame was sampled and the deltaTime they were applied with. Replaying the frames in order feeds the
+// camera exactly the same calls, so two runs over one recording draw the same frames whatever the machine or frame rate.
+const char INPUT_LOG_MAGIC[4] = { 'L', 'I', 'N', 'P' };
+const std::uint32_t INPUT_LOG_VERSION = 1;
+
+struct InputLogHeader
+{
+    char magic[4];
+    std::uint32_t version;
+};
+
+// bits of InputFrameHeader::keys
+const std::uint8_t INPUT_KEY_FORWARD = 1 << 0;
+const std::uint8_t INPUT_KEY_BACKWARD = 1 << 1;
+const std::uint8_t INPUT_KEY_LEFT = 1 << 2;
+const std::uint8_t INPUT_KEY_RIGHT = 1 << 3;
+
+struct InputFrameHeader
+{
+    float deltaTime;
+    std::uint8_t keys;
+    std::uint8_t reserved;
+    std::uint16_t eventCount;
+};
+
+enum InputEventType : std::uint8_t
+{
+    INPUT_MOUSE_MOVE, // x, y: offsets as passed to Camera::ProcessMouseMovement
+    INPUT_SCROLL      // y: as passed to Camera::ProcessMouseScroll
+};
+
+struct InputEvent
+{
+    std::uint8_t type;
+    std::uint8_t reserved[3];
+    float x;
+    float y;
+};
+
+// the structs are written and read as raw bytes, so their layout must not depend on the compiler
+static_assert(sizeof(InputLogHeader) == 8, "InputLogHeader layout changed");
+static_assert(sizeof(InputFrameHeader) == 8, "InputFrameHeader layout changed");
+static_assert(sizeof(InputEvent) == 12, "InputEvent layout changed");
+
+struct InputFrame
+{
+    float deltaTime;
+    std::uint8_t keys;
+    std::vector<InputEvent> events;
+};
+
+// --record <file>: collects events as the callbacks see them and writes one frame each time endFrame is called
+class InputRecorder
+{
+public:
+    InputRecorder();
+
+    bool open(const std::string& path);
+    bool isOpen() const { return out.is_open(); }
+    void close();
+
+    void mouseMove(float xoffset, float yoffset);
+    void scroll(float yoffset);
+    // write the frame: the events since the last call, then the keys and deltaTime the camera moved with
+    void endFrame(float deltaTime, std::uint8_t keys);
+
+    std::uint64_t frames() const { return frameCount; }
+
+private:
+    std::ofstream out;
+    std::vector<InputEvent> pending;
+    std::uint64_t frameCount;
+};
+
+// --replay <file>: hands the recorded frames back one at a time
+class InputReplay
+{
+public:
+    InputReplay();
+
+    bool open(const std::string& path);
+    bool isOpen() const { return file.isOpen(); }
+
+    // false once the recording is used up (or the rest of it is truncated)
+    bool next(InputFrame& frame);
+
+    std::uint64_t frames() const { return frameCount; }
+
+private:
+    MappedFile file;
+    std::size_t cursor;
+    std::uint64_t frameCount;
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Job;
+
+// counts unfinished jobs. run() adds one per job and each job subtracts one when done; wait() blocks (helping out) until zero,
+// and runAfter() parks a job on the counter until it reaches zero, which is how dependencies are expressed.
+class JobCounter
+{
+public:
+    JobCounter() : value(0) {}
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool done() const { return value.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<int> value;
+    std::mutex waitersLock;
+    std::vector<Job*> waiters;
+};
+
+// Chase-Lev work-stealing deque: the owning thread pushes and pops at the bottom without locks, other threads steal from the
+// top with one CAS. Fixed capacity; push fails when full and the caller runs the job itself.
+class WorkStealingDeque
+{
+public:
+    explicit WorkStealingDeque(std::size_t capacity = 4096);
+
+    bool push(Job* job);  // owner only
+    Job* pop();           // owner only
+    Job* steal();         // any thread
+    std::size_t size() const;
+
+private:
+    std::vector<std::atomic<Job*>> slots;
+    std::int64_t mask;
+    alignas(64) std::atomic<std::int64_t> top;
+    alignas(64) std::atomic<std::int64_t> bottom;
+};
+
+// a fixed set of worker threads, each with its own deque, plus the thread that created the system (worker 0), which takes part
+// whenever it waits. Jobs pushed by a worker go on its own deque, where it finds them again LIFO (cache-warm); idle workers steal
+// FIFO from the others. Threads outside the system (a render or upload thread, say) submit through a locked queue.
+class JobSystem
+{
+public:
+    // threadCount includes the calling thread; 0 means one per hardware thread
+    explicit JobSystem(unsigned int threadCount = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void run(std::function<void()> work, JobCounter* counter = NULL);
+    // queue work once dependency reaches zero (immediately if it already has)
+    void runAfter(JobCounter& dependency, std::function<void()> work, JobCounter* counter = NULL);
+    // run jobs until the counter reaches zero; safe to call from inside a job
+    void wait(JobCounter& counter);
+
+    // body(begin, end) over [0, count) in chunks of about grain items, returning once all of them are done
+    template <typename Body>
+    void parallelFor(std::size_t count, std::size_t grain, const Body& body)
+    {
+        if (count == 0)
+            return;
+        grain = grain ? grain : 1;
+        if (count <= grain)
+        {
+            body(std::size_t(0), count);
+            return;
+        }
+        // the jobs capture two words, which std::function stores inline, so chunking a loop doesn't touch the heap
+        struct Range
+        {
+            const Body* body;
+            std::size_t count;
+            std::size_t grain;
+        };
+        const Range range = { &body, count, grain };
+        const Range* shared = &range;
+        JobCounter counter;
+        for (std::size_t begin = 0; begin < count; begin += grain)
+        {
+            run([shared, begin]() {
+                std::size_t end = begin + shared->grain < shared->count ? begin + shared->grain : shared->count;
+                (*shared->body)(begin, end);
+            }, &counter);
+        }
+        wait(counter);
+    }
+
+    unsigned int threadCount() const { return static_cast<unsigned int>(workers.size()); }
+
+private:
+    // finished jobs go back to the worker that allocated them, so no worker's free list drains while another's keeps growing
+    struct Worker
+    {
+        WorkStealingDeque deque;
+        std::vector<Job*> freeJobs; // owner only
+        std::mutex returnedLock;
+        std::vector<Job*> returnedJobs; // run by other threads, waiting to be moved to freeJobs
+        std::thread thread;
+    };
+
+    Job* allocate(std::function<void()> work, JobCounter* counter);
+    void submit(Job* job);
+    void execute(Job* job);
+    void finish(JobCounter* counter);
+    Job* find(int self);
+    void workerLoop(int index);
+    void wake();
+    void recycle(Job* job);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    // jobs from threads outside the system: a FIFO kept in a vector (consumed from injectionHead) so it stops allocating once warm
+    std::mutex injectionLock;
+    std::vector<Job*> injection;
+    std::size_t injectionHead;
+    std::vector<Job*> externalFreeJobs; // under injectionLock
+    std::atomic<int> queued;
+    std::atomic<int> sleeping;
+    std::atomic<bool> quit;
+    std::mutex sleepLock;
+    std::condition_variable sleepCondition;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef LOD_SELECTOR_H
+#define LOD_SELECTOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "MeshFormat.h"
+
+// picks a mesh LOD per object from how many pixels its geometric error would cover on screen. An object only steps to a coarser
+// level once the error is comfortably below the threshold (threshold * (1 - hysteresis)), so one sitting right on a boundary
+// doesn't flicker between two levels every frame; stepping finer happens as soon as the threshold is crossed.
+class LodSelector
+{
+public:
+    LodSelector(float pixelThreshold = 1.0f, float hysteresis = 0.25f);
+
+    // call when the viewport or field of view changes
+    void setProjection(float fovyRadians, float viewportHeight);
+    void setThreshold(float pixelThreshold) { threshold = pixelThreshold; }
+    float projectionScale() const { return projScale; }
+
+    // screen-space size in pixels of an object-space error seen at the given distance
+    float projectedError(float objectError, float distance) const;
+    // choose a level for the object at `center` (world space) with the given uniform scale. `current` is the level the object
+    // used last frame (or -1), which is what the hysteresis works against.
+    int select(const std::vector<MeshLod>& lods, const glm::vec3& center, float scale, const glm::vec3& cameraPosition, int current) const;
+
+    // per-object state for callers that don't keep their own. update() on different objects may run on different threads as
+    // long as reserve() has made room for all of them first.
+    void reserve(std::size_t objects) { if (objects > levels.size()) levels.resize(objects, -1); }
+    int update(std::size_t object, const std::vector<MeshLod>& lods, const glm::vec3& center, float scale, const glm::vec3& cameraPosition);
+    int current(std::size_t object) const { return object < levels.size() ? levels[object] : 0; }
+
+private:
+    float threshold;
+    float hysteresis;
+    float projScale;
+    std::vector<int> levels;
+};
+
+#endif
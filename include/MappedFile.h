@@ -0,0 +1,39 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// read-only memory mapping of a whole file. The pages are faulted in by the OS on first touch, so nothing is copied
+// until the bytes are actually read.
+class MappedFile
+{
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+    const unsigned char* data() const { return static_cast<const unsigned char*>(mapping); }
+    std::size_t size() const { return length; }
+    // whether [offset, offset + bytes) lies inside the file. Written so untrusted offsets near 2^64 can't wrap past the check
+    bool contains(std::uint64_t offset, std::uint64_t bytes) const { return offset <= length && bytes <= length - offset; }
+
+private:
+    void* mapping;
+    std::size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+#include "glm/glm.hpp"
+
+#include "TextureArray.h"
+
+// a material is a base texture with an optional detail texture blended over it, both addressed as regions of a texture array
+struct Material
+{
+    TextureRegion base;
+    TextureRegion detail;
+    float detailMix = 0.0f;
+};
+
+// per-instance vertex data for batched draws: the object's model matrix and its material, so objects with different materials share one draw call
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::vec4 baseRect;
+    glm::vec4 detailRect;
+    glm::vec4 layers; // x = base layer, y = detail layer, z = detail mix
+
+    void setMaterial(const Material& material)
+    {
+        baseRect = material.base.uvRect;
+        detailRect = material.detail.uvRect;
+        layers = glm::vec4(material.base.layer, material.detail.layer, material.detailMix, 0.0f);
+    }
+
+    // point attribute locations firstLocation..firstLocation+6 at the instance buffer currently bound to GL_ARRAY_BUFFER, starting at
+    // baseInstance. GL 3.3 has no base-instance draws, so drawing a sub-range of the buffer means re-pointing the attributes.
+    static void setupAttributes(unsigned int firstLocation, std::size_t baseInstance = 0)
+    {
+        const std::size_t base = baseInstance * sizeof(InstanceData);
+        for (unsigned int column = 0; column < 4; column++)
+        {
+            glVertexAttribPointer(firstLocation + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+            glEnableVertexAttribArray(firstLocation + column);
+            glVertexAttribDivisor(firstLocation + column, 1);
+        }
+        const std::size_t offsets[3] = { offsetof(InstanceData, baseRect), offsetof(InstanceData, detailRect), offsetof(InstanceData, layers) };
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            glVertexAttribPointer(firstLocation + 4 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsets[i]));
+            glEnableVertexAttribArray(firstLocation + 4 + i);
+            glVertexAttribDivisor(firstLocation + 4 + i, 1);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "ClusterCuller.h"
+#include "CommandList.h"
+#include "MappedFile.h"
+#include "MeshFormat.h"
+#include "Shader.h"
+#include "VertexLayout.h"
+
+class GeometryPool;
+
+// vertex attribute locations used by every mesh VAO. 2-8 are taken by InstanceData (see Material.h).
+const unsigned int MESH_ATTRIB_POSITION = 0;
+const unsigned int MESH_ATTRIB_TEXCOORD = 1;
+const unsigned int MESH_ATTRIB_NORMAL = 9;
+
+// a cooked .mesh file on the GPU. The file is mapped and its vertex/index blocks handed straight to GL. Meshes up to the
+// streaming budget upload in one glBufferData per buffer; bigger ones are uploaded budget-sized chunks at a time, one chunk per
+// uploadNext() call, so a huge mesh can be streamed in over several frames without stalling any single one.
+// A mesh can instead be loaded into a GeometryPool, in which case it owns no GL objects at all: it draws from the pool's shared
+// buffers and VAO through baseVertex and an index offset. VAO/VBO/EBO are 0 then; use vertexArray().
+class Mesh
+{
+public:
+    unsigned int VAO;
+    unsigned int VBO;
+    unsigned int EBO;
+
+    Mesh();
+    ~Mesh();
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    // map the file, create the buffers and, if it fits the budget, upload everything right away
+    bool beginLoad(const std::string& path, std::size_t streamingBudgetBytes = 64u * 1024u * 1024u);
+    // upload the next chunk; returns true once the whole mesh is on the GPU
+    bool uploadNext();
+    // beginLoad and upload every chunk before returning
+    bool load(const std::string& path, std::size_t streamingBudgetBytes = 64u * 1024u * 1024u);
+    // copy the whole mesh into the pool; the pool must outlive the mesh
+    bool load(const std::string& path, GeometryPool& geometryPool);
+    bool isReady() const { return ready; }
+
+    // draw and drawInstanced use LOD 0, the full-detail mesh
+    void draw() const;
+    void drawLod(std::size_t lod) const;
+    void drawSubmesh(std::size_t submesh) const;
+    // draw the meshlet ranges that survived culler.cull(meshlets(), ...)
+    void drawClusters(const ClusterCuller& culler) const;
+    void drawInstanced(int instanceCount) const;
+    void drawLodInstanced(std::size_t lod, int instanceCount) const;
+    // the same draws, recorded into a command list instead of issued; safe from any thread once the mesh is ready
+    void recordLod(CommandList& commands, std::size_t lod) const;
+    void recordClusters(CommandList& commands, const ClusterCuller& culler) const;
+    // set the uniforms the vertex shader uses to undo this mesh's vertex quantization
+    void applyDequantization(Shader& shader) const;
+
+    const std::vector<MeshSubmesh>& submeshes() const { return submeshTable; }
+    const std::vector<MeshLod>& lods() const { return lodTable; }
+    std::size_t lodCount() const { return lodTable.size(); }
+    const std::vector<Meshlet>& meshlets() const { return meshletTable; }
+    const VertexLayout& layout() const { return vertexLayout; }
+    unsigned int vertexCount() const { return header.vertexCount; }
+    unsigned int indexCount() const { return header.indexCount; }
+    // what to bind and where this mesh's data starts, whether it owns its buffers or lives in a pool
+    unsigned int vertexArray() const;
+    GLenum indexType() const;
+    std::size_t indexSize() const;
+    std::uint32_t firstIndex() const;
+    GLint baseVertex() const;
+    glm::vec3 boundsMin() const { return glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]); }
+    glm::vec3 boundsMax() const { return glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]); }
+
+private:
+    bool open(const std::string& path);
+    void setupAttributes();
+    void release();
+    void drawRange(std::uint32_t first, std::uint32_t count, int instanceCount) const;
+
+    MappedFile file;
+    MeshFileHeader header;
+    VertexLayout vertexLayout;
+    std::vector<MeshSubmesh> submeshTable;
+    std::vector<MeshLod> lodTable;
+    std::vector<Meshlet> meshletTable;
+    GeometryPool* pool;
+    int geometry;
+    std::size_t chunkSize;
+    std::size_t vertexBytesUploaded;
+    std::size_t indexBytesUploaded;
+    bool ready;
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef MESH_FORMAT_H
+#define MESH_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "VertexLayout.h"
+
+// On-disk layout of a .mesh file, all integers little-endian:
+//   MeshFileHeader
+//   MeshSubmesh[submeshCount]   the submeshes of every LOD, LOD 0 first
+//   MeshLod[lodCount]           index/submesh ranges of each level of detail, finest first
+//   Meshlet[meshletCount]       clusters of LOD 0, each a contiguous run of its index range
+//   vertex data   vertexCount * vertexStride bytes, interleaved and quantized as described by vertexFormats, 16-byte aligned
+//   index data    indexCount * indexSize bytes, 16-byte aligned
+// The vertex and index blocks are exactly what glBufferData wants, so loading is a mapping plus one upload per buffer.
+// Every LOD indexes the same vertex block: the simplifier only ever removes vertices, so coarser levels are just shorter index lists.
+const char MESH_MAGIC[4] = { 'L', 'M', 'S', 'H' };
+const std::uint32_t MESH_VERSION = 4;
+
+struct MeshFileHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t vertexCount;
+    std::uint32_t vertexStride;
+    std::uint32_t indexCount;
+    std::uint32_t indexSize; // 2 or 4 bytes
+    std::uint32_t submeshCount;
+    std::uint32_t vertexFormats; // VertexLayout::packFormats
+    float boundsMin[3];
+    float boundsMax[3];
+    // dequantization transforms, see VertexLayout
+    float positionOffset[3];
+    float positionScale[3];
+    float texCoordTransform[4];
+    std::uint32_t lodCount;
+    std::uint32_t meshletCount;
+    std::uint64_t submeshOffset;
+    std::uint64_t lodOffset;
+    std::uint64_t meshletOffset;
+    std::uint64_t vertexOffset;
+    std::uint64_t indexOffset;
+};
+
+struct MeshSubmesh
+{
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+    std::uint32_t materialId;
+    std::uint32_t reserved;
+};
+
+struct MeshLod
+{
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+    std::uint32_t firstSubmesh;
+    std::uint32_t submeshCount;
+    float error; // how far (object-space units) this level's surface may deviate from the original
+    std::uint32_t reserved;
+};
+
+// a cluster of at most MESHLET_MAX_VERTICES vertices / MESHLET_MAX_TRIANGLES triangles, small enough to cull on its own.
+// The normal cone bounds the facing of every triangle in it: the whole cluster faces away from an eye at E when
+// dot(center - E, coneAxis) >= coneCutoff * length(center - E) + radius.
+struct Meshlet
+{
+    std::uint32_t firstIndex;
+    std::uint32_t triangleCount;
+    std::uint32_t vertexCount;
+    std::uint32_t submesh;
+    float center[3];
+    float radius;
+    float coneAxis[3];
+    float coneCutoff; // 1 when the triangles face too many ways for the cone to ever cull
+};
+
+const std::size_t MESHLET_MAX_VERTICES = 64;
+const std::size_t MESHLET_MAX_TRIANGLES = 124;
+
+static_assert(sizeof(MeshFileHeader) == 144, "MeshFileHeader layout changed");
+static_assert(sizeof(MeshSubmesh) == 16, "MeshSubmesh layout changed");
+static_assert(sizeof(MeshLod) == 24, "MeshLod layout changed");
+static_assert(sizeof(Meshlet) == 48, "Meshlet layout changed");
+
+// full-precision vertex used while cooking
+struct MeshVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+};
+
+// a mesh in CPU memory, as produced by the importers and consumed by the writer
+struct MeshData
+{
+    std::vector<MeshVertex> vertices;
+    std::vector<std::uint32_t> indices;
+    std::vector<MeshSubmesh> submeshes;
+    std::vector<MeshLod> lods; // empty means a single level made of everything above
+    std::vector<Meshlet> meshlets;
+    std::vector<std::string> materialNames; // indexed by MeshSubmesh::materialId
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+
+    void computeBounds();
+};
+
+// offline side of the mesh pipeline: import source formats and cook them into .mesh files
+namespace meshcook
+{
+    // Wavefront OBJ: v/vt/vn/f, polygons fan-triangulated, one submesh per usemtl run, identical v/vt/vn corners shared
+    bool importObj(const std::string& path, MeshData& mesh);
+    // write with the smallest vertex layout that stays inside the default quantization tolerance
+    bool writeMesh(const std::string& path, const MeshData& mesh);
+    bool writeMesh(const std::string& path, const MeshData& mesh, const VertexLayout& layout);
+
+    struct LodSettings
+    {
+        int maxLods = 5;              // including LOD 0
+        float reduction = 0.5f;       // each level keeps this fraction of the previous level's triangles
+        float maxError = 0.05f;       // stop once a level would deviate more than this, relative to the bounds diagonal
+        std::size_t minTriangles = 32; // don't bother simplifying below this
+    };
+
+    // quadric error metric simplification by half-edge collapse. Vertices shared across a UV/normal seam are locked so
+    // levels never crack, and border edges are weighted to stay put. Returns the largest geometric error introduced.
+    float simplify(const std::vector<MeshVertex>& vertices, const std::vector<std::uint32_t>& indices, const std::vector<std::uint32_t>& triangleSubmesh,
+        std::size_t targetTriangles, float maxError, std::vector<std::uint32_t>& outIndices, std::vector<std::uint32_t>& outTriangleSubmesh);
+    // append a chain of progressively simpler LODs to the mesh's index buffer and fill in mesh.lods
+    void generateLods(MeshData& mesh, const LodSettings& settings = LodSettings());
+    // split LOD 0 into meshlets, growing each greedily across shared vertices. Triangles are reordered inside their submesh so
+    // every meshlet is one contiguous index run; the submesh and LOD ranges are unchanged.
+    void buildMeshlets(MeshData& mesh, std::size_t maxVertices = MESHLET_MAX_VERTICES, std::size_t maxTriangles = MESHLET_MAX_TRIANGLES);
+}
+
+#endif
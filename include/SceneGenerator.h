@@ -0,0 +1,56 @@
+#ifndef SCENE_GENERATOR_H
+#define SCENE_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "EntityStore.h"
+
+// procedural stress scenes (--scene): any number of objects in one of a few layouts, with mesh, material, placement and which
+// objects move all drawn from a seeded generator. The same settings give the same scene on every machine (the random numbers
+// come from std::mt19937, whose output the standard fixes, and are turned into floats here rather than by a distribution), so a
+// scene can be named on the command line and compared across runs.
+namespace scenegen
+{
+    enum Layout
+    {
+        GRID,      // a flat square grid on y = 0
+        RANDOM,    // uniform in a cube whose size grows with the count, so density stays the same
+        CLUSTERED, // dense blobs scattered through a larger volume: some views see thousands of objects, others almost none
+        CITY       // towers of stacked objects on lots in blocks separated by streets
+    };
+
+    struct Settings
+    {
+        Layout layout = GRID;
+        std::size_t count = 1000;
+        std::uint32_t seed = 1;
+        float dynamicFraction = 0.0f; // share of objects that spin every frame
+        std::uint32_t meshCount = 1;  // meshIds are spread over [0, meshCount)
+        std::uint32_t materialCount = 1;
+        float spacing = 3.0f; // typical distance between neighbours
+    };
+
+    // an object that moves: it spins about a fixed axis from its starting rotation
+    struct Spinner
+    {
+        Entity entity;
+        glm::quat rest;
+        glm::vec3 axis;
+        float speed; // radians per second
+    };
+
+    bool parseLayout(const char* name, Layout& layout);
+    const char* layoutName(Layout layout);
+
+    // adds settings.count root entities to the scene; meshBounds[meshId] is the object-space bounding sphere of each mesh
+    void generate(const Settings& settings, const glm::vec4* meshBounds, EntityStore& scene, std::vector<Spinner>& spinners);
+    // turn every spinner to where it is at `time` seconds
+    void animate(const std::vector<Spinner>& spinners, float time, EntityStore& scene);
+}
+
+#endif
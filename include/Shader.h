@@ -4,14 +4,31 @@
 #include <glad/glad.h> // include glad to get all the required OpenGL headers
 
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
+#include "Hash.h"
+
+// a uniform name and its FNV-1a hash, which is what Shader looks cached locations up by. Converts implicitly from string literals,
+// const char*, std::string_view and std::string without copying the text; declared constexpr, the hash is computed at compile time:
+//     constexpr UniformName MODEL("model");
+// The text is only read on the first lookup of a name, and must stay alive for the call.
+struct UniformName
+{
+    constexpr UniformName(const char* name) : UniformName(std::string_view(name)) {}
+    constexpr UniformName(std::string_view name) : text(name), hash(fnv1a64Text(name)) {}
+    UniformName(const std::string& name) : UniformName(std::string_view(name)) {}
+
+    std::string_view text;
+    std::uint64_t hash;
+};
 
 class Shader
 {
@@ -21,24 +38,32 @@ public:
 
     // constructor reads and builds the shader
     Shader(const char* vertexPath, const char* fragmentPath);
+    // constructor builds the shader from source already in memory (e.g. an AssetPack blob); the sources don't need to be NUL-terminated
+    Shader(const char* vertexCode, int vertexLength, const char* fragmentCode, int fragmentLength);
     // use/activate the shader
     void use();
+    // location of a uniform, -1 if the program doesn't have it. Asks GL once per name and serves repeats from a cache keyed by the
+    // name's hash, so the per-frame setters below neither build strings nor call glGetUniformLocation.
+    GLint location(UniformName name) const;
     // utility uniform functions
-    void setBool(const std::string& name, bool value) const;
-    void setInt(const std::string& name, int value) const;
-    void setFloat(const std::string& name, float value) const;
-    void setVec2(const std::string& name, const glm::vec2& value) const;
-    void setVec2(const std::string& name, float x, float y) const;
-    void setVec3(const std::string& name, const glm::vec3& value) const;
-    void setVec3(const std::string& name, float x, float y, float z) const;
-    void setVec4(const std::string& name, const glm::vec4& value) const;
-    void setVec4(const std::string& name, float x, float y, float z, float w) const;
-    void setMat2(const std::string& name, const glm::mat2& mat) const;
-    void setMat3(const std::string& name, const glm::mat3& mat) const;
-    void setMat4(const std::string& name, const glm::mat4& mat) const;
+    void setBool(UniformName name, bool value) const;
+    void setInt(UniformName name, int value) const;
+    void setFloat(UniformName name, float value) const;
+    void setVec2(UniformName name, const glm::vec2& value) const;
+    void setVec2(UniformName name, float x, float y) const;
+    void setVec3(UniformName name, const glm::vec3& value) const;
+    void setVec3(UniformName name, float x, float y, float z) const;
+    void setVec4(UniformName name, const glm::vec4& value) const;
+    void setVec4(UniformName name, float x, float y, float z, float w) const;
+    void setMat2(UniformName name, const glm::mat2& mat) const;
+    void setMat3(UniformName name, const glm::mat3& mat) const;
+    void setMat4(UniformName name, const glm::mat4& mat) const;
 
 private:
+    void compile(const char* vertexCode, int vertexLength, const char* fragmentCode, int fragmentLength);
     void checkCompileErrors(unsigned int shader, std::string type);
+
+    mutable std::unordered_map<std::uint64_t, GLint> locations;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+
+#include "glm/glm.hpp"
+
+#include "TextureCache.h"
+
+// where a material's texels live inside a texture array: the layer, and the sub-rectangle of that layer as (offset.xy, scale.xy) in UV space
+struct TextureRegion
+{
+    float layer = 0.0f;
+    glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+};
+
+// a GL_TEXTURE_2D_ARRAY of same-size RGBA8 layers. Materials that share one array can be drawn in a single batch,
+// each instance selecting its layer instead of rebinding textures between draws.
+class TextureArray
+{
+public:
+    // the texture array ID
+    unsigned int ID;
+
+    TextureArray(int width, int height, int layers, const TextureOptions& options = TextureOptions());
+    ~TextureArray();
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    // decode an image into the next free layer. Returns the layer, or -1 if the file can't be read, has the wrong size or the array is full.
+    int addLayer(const std::string& path);
+    // same, but decodes an encoded image that's already in memory (e.g. an AssetPack blob)
+    int addLayer(const std::string& name, const unsigned char* encoded, std::size_t size);
+    // upload width*height RGBA8 pixels into the next free layer
+    int addLayer(const unsigned char* rgba);
+    // upload RGBA8 pixels into a sub-rectangle of an existing layer
+    void setRegion(int layer, int x, int y, int regionWidth, int regionHeight, const unsigned char* rgba);
+    // call once every layer is filled, if the options asked for mipmaps
+    void generateMipmaps();
+
+    void bind(unsigned int unit) const;
+    TextureRegion region(int layer) const;
+
+    int width() const { return layerWidth; }
+    int height() const { return layerHeight; }
+    int layers() const { return layerCount; }
+    int usedLayers() const { return nextLayer; }
+
+private:
+    int addDecoded(const std::string& name, unsigned char* data, int width, int height);
+
+    int layerWidth;
+    int layerHeight;
+    int layerCount;
+    int nextLayer;
+    TextureOptions options;
+};
+
+#endif
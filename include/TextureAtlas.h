@@ -0,0 +1,55 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TextureArray.h"
+
+// skyline bottom-left rectangle packer for one square page. Pure CPU, no GL calls.
+class RectPacker
+{
+public:
+    explicit RectPacker(int pageSize);
+
+    // find room for a w x h rectangle. Returns false if it doesn't fit on this page.
+    bool insert(int w, int h, int& x, int& y);
+    void reset();
+    // fraction of the page covered by inserted rectangles
+    float occupancy() const;
+
+private:
+    struct Segment
+    {
+        int x, y, width;
+    };
+
+    // lowest y a rectangle of width w can sit at when its left edge is at segment index i, or -1 if it runs off the page
+    int fitAt(std::size_t i, int w, int h) const;
+
+    int size;
+    long long usedArea;
+    std::vector<Segment> skyline;
+};
+
+// packs images of mixed sizes into as few atlas pages as possible. Each page is one layer of the resulting texture array,
+// so every packed image is addressed by a TextureRegion (layer + UV rect) and can be drawn in the same batch.
+class TextureAtlasBuilder
+{
+public:
+    // padding is the number of texels of edge-extended gutter around each image, to keep filtering from bleeding into neighbours
+    explicit TextureAtlasBuilder(int pageSize = 2048, int padding = 4);
+
+    // queue an image. Returns its index into the regions produced by build().
+    int add(const std::string& path);
+    // decode, pack and upload every queued image. regions[i] is where image i ended up; a failed image gets layer -1.
+    std::unique_ptr<TextureArray> build(std::vector<TextureRegion>& regions, const TextureOptions& options = TextureOptions());
+
+private:
+    int pageSize;
+    int padding;
+    std::vector<std::string> paths;
+};
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "UploadThread.h"
+
+// sampler/format options a texture is created with. Two loads of the same file with different options are different textures.
+struct TextureOptions
+{
+    GLint wrapS = GL_REPEAT;
+    GLint wrapT = GL_REPEAT;
+    GLint minFilter = GL_LINEAR_MIPMAP_LINEAR;
+    GLint magFilter = GL_LINEAR;
+    bool generateMipmaps = true;
+    bool flipVertically = true;
+    // 0 keeps the channel count stored in the file, 1-4 forces it
+    int desiredChannels = 0;
+
+    std::string key() const;
+};
+
+struct TextureCacheStats
+{
+    std::size_t hits = 0;
+    std::size_t contentHits = 0; // misses on the path that matched an already resident file by content
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::size_t texturesResident = 0;
+    std::size_t bytesResident = 0;
+};
+
+class TextureCache;
+
+// refcounted reference to a cached texture. While at least one handle is alive the texture can't be evicted.
+class TextureHandle
+{
+public:
+    TextureHandle();
+    TextureHandle(const TextureHandle& other);
+    TextureHandle(TextureHandle&& other) noexcept;
+    TextureHandle& operator=(TextureHandle other) noexcept;
+    ~TextureHandle();
+
+    // the OpenGL texture name, 0 if the handle is empty or the load failed
+    unsigned int id() const;
+    int width() const;
+    int height() const;
+    int channels() const;
+    explicit operator bool() const { return id() != 0; }
+
+    // bind to GL_TEXTURE0 + unit
+    void bind(unsigned int unit) const;
+
+private:
+    friend class TextureCache;
+    TextureHandle(TextureCache* cache, std::size_t slot, std::uint32_t generation);
+
+    TextureCache* cache;
+    std::size_t slot;
+    std::uint32_t generation;
+};
+
+// decodes and uploads each (file, options) pair once and hands out shared handles to it.
+// Textures nobody holds a handle to stay resident until the VRAM budget is exceeded, then the least recently released go first.
+class TextureCache
+{
+public:
+    explicit TextureCache(std::size_t vramBudgetBytes = 256u * 1024u * 1024u);
+    ~TextureCache();
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // returns the cached texture for path+options, loading it on a miss. Returns an empty handle if the file can't be loaded.
+    TextureHandle load(const std::string& path, const TextureOptions& options = TextureOptions());
+    // same as load, but decodes an encoded image that's already in memory (e.g. a mapped AssetPack blob) without copying it. The
+    // bytes must stay valid while the texture is cached: a later load with the same content hash is compared against them
+    TextureHandle loadFromMemory(const std::string& name, const unsigned char* data, std::size_t size, const TextureOptions& options = TextureOptions());
+
+    // hand texture uploads to a loader thread from now on (NULL goes back to uploading in load()). Decoding still happens in load(),
+    // but handles to a texture report id 0 until poll() has seen its upload complete, so draws go ahead without it meanwhile.
+    void setUploader(UploadThread* uploader);
+    // on the render thread, once per frame: publish textures whose uploads have finished
+    void poll();
+    // block until every queued upload is visible, e.g. before handing texture names to something that keeps them
+    void finishUploads();
+
+    void setBudget(std::size_t vramBudgetBytes);
+    std::size_t budget() const { return vramBudget; }
+    // evict unreferenced textures until at most targetBytes are resident
+    void trim(std::size_t targetBytes);
+    // delete every texture, referenced or not. Must run while the GL context is still current.
+    void clear();
+
+    const TextureCacheStats& stats() const { return cacheStats; }
+    void resetCounters();
+
+private:
+    friend class TextureHandle;
+
+    struct Entry
+    {
+        std::vector<std::string> keys; // every path key that resolves to this texture
+        std::uint64_t contentKey = 0;
+        // where the encoded bytes came from, so a content hit can compare them and a hash collision can't alias two files:
+        // the caller's memory for loadFromMemory, otherwise the file, read again only on a hit
+        std::string source;
+        const unsigned char* sourceData = nullptr;
+        std::size_t sourceSize = 0;
+        unsigned int id = 0;
+        int width = 0, height = 0, channels = 0;
+        std::size_t bytes = 0;
+        int refCount = 0;
+        std::uint32_t generation = 0;
+        bool inLru = false;
+        bool uploaded = true; // false while the loader thread is still filling the texture
+        std::list<std::size_t>::iterator lruIt;
+    };
+
+    struct PendingUpload
+    {
+        UploadTicket ticket;
+        std::size_t slot;
+        std::uint32_t generation;
+        unsigned int id;
+    };
+
+    TextureHandle create(const std::string& pathKey, const std::string& name, const unsigned char* fileBytes, std::size_t fileSize,
+        bool inMemory, const TextureOptions& options);
+    bool sameSource(const Entry& entry, const unsigned char* fileBytes, std::size_t fileSize) const;
+    TextureHandle acquire(std::size_t slot);
+    void addRef(std::size_t slot, std::uint32_t generation);
+    void release(std::size_t slot, std::uint32_t generation);
+    const Entry* lookup(std::size_t slot, std::uint32_t generation) const;
+    void evict(std::size_t slot);
+    void enforceBudget();
+    void completeUpload(const PendingUpload& upload);
+
+    std::vector<Entry> entries;
+    std::vector<std::size_t> freeSlots;
+    std::unordered_map<std::string, std::size_t> byPath;
+    std::unordered_map<std::uint64_t, std::size_t> byContent;
+    std::list<std::size_t> lru; // unreferenced entries, front was released most recently
+    UploadThread* uploader;
+    std::vector<PendingUpload> pendingUploads;
+    std::size_t vramBudget;
+    TextureCacheStats cacheStats;
+};
+
+#endif
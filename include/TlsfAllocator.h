@@ -0,0 +1,84 @@
+#ifndef TLSF_ALLOCATOR_H
+#define TLSF_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// one allocation handed out by TlsfAllocator. node identifies it for free(); size may be a little larger than asked for.
+struct TlsfAllocation
+{
+    static const std::uint32_t INVALID = 0xFFFFFFFFu;
+
+    std::uint32_t offset = 0;
+    std::uint32_t size = 0;
+    std::uint32_t node = INVALID;
+
+    bool valid() const { return node != INVALID; }
+};
+
+struct TlsfStats
+{
+    std::size_t capacity = 0;
+    std::size_t used = 0;
+    std::size_t free = 0;
+    std::size_t largestFree = 0;
+    std::size_t allocations = 0;
+    std::size_t freeBlocks = 0;
+    // 0 when all free space is one block, approaching 1 as it splinters into pieces too small to be useful
+    float fragmentation() const { return free ? 1.0f - static_cast<float>(largestFree) / static_cast<float>(free) : 0.0f; }
+};
+
+// two-level segregated fit allocator over an abstract range [0, capacity). It never touches the memory it manages, so the same
+// code hands out byte ranges of GL buffers, element ranges, or anything else addressed by offset. Free blocks are binned by size
+// class (power of two, then 16 linear steps) with a bitmap per level, so allocate and free are O(1); neighbouring free blocks
+// are merged on free.
+class TlsfAllocator
+{
+public:
+    explicit TlsfAllocator(std::uint32_t capacity = 0);
+
+    // forget every allocation and manage [0, capacity) as one free block
+    void reset(std::uint32_t capacity);
+    // offset is a multiple of alignment (any value, not just powers of two); returns an invalid allocation when nothing fits
+    TlsfAllocation allocate(std::uint32_t size, std::uint32_t alignment = 1);
+    void free(const TlsfAllocation& allocation);
+
+    std::uint32_t capacity() const { return totalSize; }
+    TlsfStats stats() const;
+
+private:
+    static const int SL_BITS = 4;
+    static const int SL_COUNT = 1 << SL_BITS;
+    static const int FL_COUNT = 32;
+
+    struct Block
+    {
+        std::uint32_t offset;
+        std::uint32_t size;
+        std::uint32_t prevPhysical;
+        std::uint32_t nextPhysical;
+        std::uint32_t prevFree;
+        std::uint32_t nextFree;
+        bool free;
+    };
+
+    static void mapping(std::uint32_t size, int& fl, int& sl);
+    std::uint32_t newBlock(std::uint32_t offset, std::uint32_t size);
+    void insertFree(std::uint32_t node);
+    void removeFree(std::uint32_t node);
+    std::uint32_t findFree(std::uint32_t size) const;
+    // split the tail of a block off into a new free block, returning the new node
+    std::uint32_t splitTail(std::uint32_t node, std::uint32_t keep);
+
+    std::vector<Block> blocks;
+    std::vector<std::uint32_t> unusedBlocks;
+    std::uint32_t flBitmap;
+    std::uint32_t slBitmap[FL_COUNT];
+    std::uint32_t heads[FL_COUNT][SL_COUNT];
+    std::uint32_t totalSize;
+    std::size_t usedSize;
+    std::size_t allocationCount;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef TRANSFORM_KERNELS_H
+#define TRANSFORM_KERNELS_H
+
+#include <cstddef>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+// batched world-matrix composition: world[i] = translate(position[i]) * mat4_cast(rotation[i]) * scale(scale[i]), the same matrix
+// glm would build, for whole arrays at once. The SSE kernel does 4 objects per step and the AVX2/FMA one 8, computing each matrix
+// entry for all of them in one register and transposing back to column-major matrices on the way out. Which kernel runs is
+// decided once from CPUID (and whether the OS saves the AVX registers); non-x86 builds always use the scalar loop.
+namespace transformkernels
+{
+    enum Level
+    {
+        SCALAR,
+        SSE,
+        AVX2
+    };
+
+    // the best level this CPU supports
+    Level detect();
+    // the level compose() uses. setActive is for comparing kernels; it won't go above detect().
+    Level active();
+    void setActive(Level level);
+    const char* name(Level level);
+
+    void compose(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, std::size_t count, glm::mat4* world);
+    // also clip[i] = viewProjection * world[i]
+    void composeViewProjection(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, std::size_t count,
+        const glm::mat4& viewProjection, glm::mat4* world, glm::mat4* clip);
+
+    // --bench-transforms: times glm against each kernel the CPU supports on `count` random transforms and checks they agree
+    int benchmark(std::size_t count);
+}
+
+#endif
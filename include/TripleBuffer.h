@@ -0,0 +1,70 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+// hands values from one producer thread to one consumer thread without either touching the slot the other is working on.
+// The producer fills writeSlot() and publish()es it; the consumer acquire()s the newest published value and keeps it until the
+// next acquire. The third slot holds whatever is published but not yet picked up, so publishing never has to wait for the
+// consumer to finish with its copy. waitUntilConsumed() lets the producer stay at most one value ahead instead of dropping frames.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : writeIndex(0), readyIndex(1), readIndex(2), fresh(false), closed(false) {}
+
+    // producer side
+    T& writeSlot() { return slots[writeIndex]; }
+    void publish()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::swap(writeIndex, readyIndex);
+            fresh = true;
+        }
+        condition.notify_all();
+    }
+    void waitUntilConsumed()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return !fresh || closed; });
+    }
+
+    // consumer side: block until something new is published; NULL once closed
+    const T* acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return fresh || closed; });
+        if (closed)
+            return NULL;
+        std::swap(readIndex, readyIndex);
+        fresh = false;
+        lock.unlock();
+        condition.notify_all();
+        return &slots[readIndex];
+    }
+
+    // wake everyone up for shutdown
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        condition.notify_all();
+    }
+
+private:
+    T slots[3];
+    int writeIndex;
+    int readyIndex;
+    int readIndex;
+    bool fresh;
+    bool closed;
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+#endif
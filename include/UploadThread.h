@@ -0,0 +1,71 @@
+#ifndef UPLOAD_THREAD_H
+#define UPLOAD_THREAD_H
+
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+struct GLFWwindow;
+
+typedef std::uint64_t UploadTicket;
+
+// runs glTexImage2D/glBufferData style work on a loader thread with its own GL context, shared with the main window's so the
+// objects it fills are visible to the renderer. After each piece of work the loader inserts a fence and flushes; the render thread
+// asks ready(ticket) once per frame, which only checks the fence without blocking, and uses the object once it says yes. Large
+// uploads then cost the render thread nothing but the check.
+//
+// Create and destroy it on the main thread (GLFW windows can only be made there); everything else is fine from any thread, except
+// that ready()/wait() need some context of the share group current, normally the renderer's.
+class UploadThread
+{
+public:
+    // creates a hidden window whose context shares objects with `shareWith` and starts the loader thread
+    explicit UploadThread(GLFWwindow* shareWith);
+    // runs whatever is still queued, then stops the thread and destroys the hidden window
+    ~UploadThread();
+    UploadThread(const UploadThread&) = delete;
+    UploadThread& operator=(const UploadThread&) = delete;
+
+    // false if the shared context couldn't be created; callers should upload on their own thread instead
+    bool valid() const { return window != NULL; }
+
+    // queue GL work for the loader context. What it writes is visible to the renderer once ready() says so for its ticket, and only
+    // to binds made after that point: binding is what picks up changes another context made to an object.
+    UploadTicket submit(std::function<void()> work);
+    // true once the ticket's work has run and the GPU has finished it. A ticket reports true exactly once; after that it's forgotten.
+    bool ready(UploadTicket ticket);
+    // block until ready(ticket) would return true, and retire it
+    void wait(UploadTicket ticket);
+
+    // submitted tickets that haven't been retired by ready()/wait() yet
+    std::size_t pending() const;
+
+private:
+    struct Work
+    {
+        UploadTicket ticket;
+        std::function<void()> work;
+    };
+
+    void loaderLoop();
+    GLsync takeFence(UploadTicket ticket, bool block);
+
+    GLFWwindow* window;
+    std::thread thread;
+    mutable std::mutex lock;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+    std::deque<Work> queue;
+    std::unordered_map<UploadTicket, GLsync> fences; // work that has run, waiting for the renderer to see its fence signal
+    UploadTicket nextTicket;
+    std::size_t outstanding;
+    bool quit;
+};
+
+#endif
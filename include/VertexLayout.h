@@ -0,0 +1,72 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+struct MeshData;
+
+// storage formats for a single vertex attribute, smallest first within each group
+enum VertexFormat : std::uint8_t
+{
+    VERTEX_FORMAT_NONE = 0,
+    VERTEX_FORMAT_FLOAT2,      // 8 bytes
+    VERTEX_FORMAT_FLOAT3,      // 12 bytes
+    VERTEX_FORMAT_HALF2,       // 4 bytes, GL_HALF_FLOAT
+    VERTEX_FORMAT_HALF4,       // 8 bytes, xyz + padding
+    VERTEX_FORMAT_SNORM16X4,   // 8 bytes, xyz + padding, normalized to [-1,1] around the mesh bounds
+    VERTEX_FORMAT_UNORM16X2,   // 4 bytes, normalized to [0,1] over the UV range
+    VERTEX_FORMAT_SNORM10X3    // 4 bytes, GL_INT_2_10_10_10_REV, for unit normals
+};
+
+// how the interleaved vertices of a mesh are stored: one format per attribute, always in position/texcoord/normal order,
+// plus the affine transforms the vertex shader applies to undo the normalization
+struct VertexLayout
+{
+    VertexFormat position = VERTEX_FORMAT_FLOAT3;
+    VertexFormat texCoord = VERTEX_FORMAT_FLOAT2;
+    VertexFormat normal = VERTEX_FORMAT_FLOAT3;
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec3 positionScale = glm::vec3(1.0f);
+    glm::vec4 texCoordTransform = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // offset.xy, scale.zw
+
+    std::size_t positionOffsetBytes() const { return 0; }
+    std::size_t texCoordOffsetBytes() const;
+    std::size_t normalOffsetBytes() const;
+    std::size_t stride() const;
+
+    // point the given attribute locations at the vertex buffer currently bound to GL_ARRAY_BUFFER
+    void apply(unsigned int positionLocation, unsigned int texCoordLocation, unsigned int normalLocation) const;
+    // pack each attribute's format into one word, for storing in file headers
+    std::uint32_t packFormats() const;
+    void unpackFormats(std::uint32_t packed);
+};
+
+// how much error the cooker accepts when picking a smaller format
+struct QuantizationTolerance
+{
+    float position = 1e-4f;  // object-space units
+    float texCoord = 1.0f / 4096.0f; // UV units, i.e. a quarter texel of a 1024 texture
+    float normal = 2e-3f;    // per component
+};
+
+namespace vertexlayout
+{
+    std::size_t formatSize(VertexFormat format);
+    // pick the smallest format per attribute whose worst-case error over this mesh stays inside the tolerance
+    VertexLayout choose(const MeshData& mesh, const QuantizationTolerance& tolerance = QuantizationTolerance());
+    // a layout that stores everything as plain floats
+    VertexLayout full();
+    // encode the mesh's vertices into interleaved bytes laid out as described
+    void encode(const MeshData& mesh, const VertexLayout& layout, std::vector<unsigned char>& out);
+
+    std::uint16_t floatToHalf(float value);
+    float halfToFloat(std::uint16_t half);
+}
+
+#endif
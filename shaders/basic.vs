@@ -5,12 +5,16 @@ layout (location = 1) in vec2 aTexCoord;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+// undo the mesh's vertex quantization; the defaults are the identity used by plain float vertices (see VertexLayout)
+uniform vec3 positionOffset = vec3(0.0);
+uniform vec3 positionScale = vec3(1.0);
+uniform vec4 texCoordTransform = vec4(0.0, 0.0, 1.0, 1.0);
 out vec2 TexCoord;
 
 uniform mat4 transform;
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0f);
-	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+	gl_Position = projection * view * model * vec4(positionOffset + aPos * positionScale, 1.0f);
+	TexCoord = texCoordTransform.xy + aTexCoord * texCoordTransform.zw;
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in vec4 BaseRect;
+flat in vec4 DetailRect;
+flat in vec3 Layers;
+
+// every material's texels live in one texture array, so instances never need a rebind
+uniform sampler2DArray materials;
+
+// map the mesh UV into the material's sub-rectangle. UVs outside [0,1] are wrapped with fract to keep GL_REPEAT-style tiling inside atlas regions
+vec4 sampleRegion(vec4 rect, float layer)
+{
+	vec2 local = mix(fract(TexCoord), TexCoord, vec2(equal(clamp(TexCoord, 0.0, 1.0), TexCoord)));
+	vec2 uv = rect.xy + local * rect.zw;
+	return texture(materials, vec3(uv, layer));
+}
+
+void main()
+{
+	vec4 base = sampleRegion(BaseRect, Layers.x);
+	if (Layers.z > 0.0)
+		FragColor = mix(base, sampleRegion(DetailRect, Layers.y), Layers.z);
+	else
+		FragColor = base;
+}
@@ -0,0 +1,29 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// per-instance data, see InstanceData in Material.h
+layout (location = 2) in mat4 aModel;
+layout (location = 6) in vec4 aBaseRect;
+layout (location = 7) in vec4 aDetailRect;
+layout (location = 8) in vec4 aLayers;
+
+uniform mat4 view;
+uniform mat4 projection;
+// undo the mesh's vertex quantization; the defaults are the identity used by plain float vertices (see VertexLayout)
+uniform vec3 positionOffset = vec3(0.0);
+uniform vec3 positionScale = vec3(1.0);
+uniform vec4 texCoordTransform = vec4(0.0, 0.0, 1.0, 1.0);
+
+out vec2 TexCoord;
+flat out vec4 BaseRect;
+flat out vec4 DetailRect;
+flat out vec3 Layers;
+
+void main()
+{
+	gl_Position = projection * view * aModel * vec4(positionOffset + aPos * positionScale, 1.0f);
+	TexCoord = texCoordTransform.xy + aTexCoord * texCoordTransform.zw;
+	BaseRect = aBaseRect;
+	DetailRect = aDetailRect;
+	Layers = aLayers.xyz;
+}
@@ -0,0 +1,39 @@
+#version 450 core
+#extension GL_ARB_bindless_texture : require
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in vec4 BaseRect;
+flat in vec4 DetailRect;
+flat in vec3 Materials;
+
+// the draw's base and detail material IDs. They come from a uniform rather than the instance attributes because a bindless handle
+// has to be dynamically uniform; the renderer splits its instanced draws by material so this holds
+uniform vec2 materialIds;
+
+// resident texture handles indexed by material ID, two 64-bit handles per std140 element (see BindlessTextureTable)
+layout (std140) uniform MaterialHandles
+{
+	uvec4 handles[512];
+};
+
+sampler2D materialSampler(int material)
+{
+	uvec4 pair = handles[material >> 1];
+	return sampler2D((material & 1) == 0 ? pair.xy : pair.zw);
+}
+
+vec4 sampleRegion(vec4 rect, int material)
+{
+	vec2 local = mix(fract(TexCoord), TexCoord, vec2(equal(clamp(TexCoord, 0.0, 1.0), TexCoord)));
+	return texture(materialSampler(material), rect.xy + local * rect.zw);
+}
+
+void main()
+{
+	vec4 base = sampleRegion(BaseRect, int(materialIds.x));
+	if (Materials.z > 0.0)
+		FragColor = mix(base, sampleRegion(DetailRect, int(materialIds.y)), Materials.z);
+	else
+		FragColor = base;
+}
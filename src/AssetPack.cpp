@@ -0,0 +1,173 @@
+#include"../include/AssetPack.h"
+#include"../include/Hash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace
+{
+    std::uint64_t hashName(const std::string& name)
+    {
+        return fnv1a64(name.data(), name.size());
+    }
+
+    std::uint64_t alignUp(std::uint64_t value, std::uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+// AssetPack
+// ------------------------------------------------------------------------
+AssetPack::AssetPack() : entries(nullptr), names(nullptr), count(0)
+{
+}
+
+AssetPack::AssetPack(const std::string& path) : AssetPack()
+{
+    open(path);
+}
+
+bool AssetPack::open(const std::string& path)
+{
+    entries = nullptr;
+    names = nullptr;
+    count = 0;
+    if (!file.open(path))
+        return false;
+
+    // validate the header and tables once here so find() can trust every offset
+    const AssetPackHeader* header = reinterpret_cast<const AssetPackHeader*>(file.data());
+    bool valid = file.size() >= sizeof(AssetPackHeader)
+        && std::memcmp(header->magic, ASSET_PACK_MAGIC, sizeof(ASSET_PACK_MAGIC)) == 0
+        && header->version == ASSET_PACK_VERSION
+        && file.contains(header->tocOffset, static_cast<std::uint64_t>(header->entryCount) * sizeof(AssetPackEntry))
+        && file.contains(header->namesOffset, header->namesSize);
+    if (valid)
+    {
+        const AssetPackEntry* toc = reinterpret_cast<const AssetPackEntry*>(file.data() + header->tocOffset);
+        for (std::uint32_t i = 0; i < header->entryCount && valid; i++)
+        {
+            valid = file.contains(toc[i].offset, toc[i].size)
+                && toc[i].nameOffset <= header->namesSize && toc[i].nameLength <= header->namesSize - toc[i].nameOffset;
+        }
+    }
+    if (!valid)
+    {
+        std::cout << "ERROR::ASSET_PACK::INVALID_PACK: " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    entries = reinterpret_cast<const AssetPackEntry*>(file.data() + header->tocOffset);
+    names = reinterpret_cast<const char*>(file.data() + header->namesOffset);
+    count = header->entryCount;
+    return true;
+}
+
+AssetBlob AssetPack::find(const std::string& name) const
+{
+    AssetBlob blob;
+    const std::uint64_t hash = hashName(name);
+    const AssetPackEntry* end = entries + count;
+    const AssetPackEntry* it = std::lower_bound(entries, end, hash,
+        [](const AssetPackEntry& entry, std::uint64_t value) { return entry.nameHash < value; });
+    // hashes can collide, so confirm against the stored name
+    for (; it != end && it->nameHash == hash; ++it)
+    {
+        if (it->nameLength == name.size() && std::memcmp(names + it->nameOffset, name.data(), name.size()) == 0)
+        {
+            blob.data = file.data() + it->offset;
+            blob.size = static_cast<std::size_t>(it->size);
+            break;
+        }
+    }
+    return blob;
+}
+
+// AssetPackWriter
+// ------------------------------------------------------------------------
+void AssetPackWriter::addFile(const std::string& path)
+{
+    std::string name = path;
+    std::replace(name.begin(), name.end(), '\\', '/');
+    addFile(path, name);
+}
+
+void AssetPackWriter::addFile(const std::string& path, const std::string& name)
+{
+    sources.push_back(Source{ path, name });
+}
+
+bool AssetPackWriter::write(const std::string& outputPath) const
+{
+    // read every source up front so a missing file doesn't leave a half-written pack behind
+    std::vector<std::vector<char>> contents(sources.size());
+    for (std::size_t i = 0; i < sources.size(); i++)
+    {
+        std::ifstream in(sources[i].path, std::ios::binary);
+        if (!in)
+        {
+            std::cout << "ERROR::ASSET_PACK::FILE_NOT_SUCCESSFULLY_READ: " << sources[i].path << std::endl;
+            return false;
+        }
+        contents[i].assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    AssetPackHeader header;
+    std::memcpy(header.magic, ASSET_PACK_MAGIC, sizeof(ASSET_PACK_MAGIC));
+    header.version = ASSET_PACK_VERSION;
+    header.entryCount = static_cast<std::uint32_t>(sources.size());
+    header.tocOffset = sizeof(AssetPackHeader);
+    header.namesOffset = header.tocOffset + sources.size() * sizeof(AssetPackEntry);
+
+    std::vector<AssetPackEntry> toc(sources.size());
+    std::string names;
+    for (std::size_t i = 0; i < sources.size(); i++)
+    {
+        toc[i].nameHash = hashName(sources[i].name);
+        toc[i].nameOffset = static_cast<std::uint32_t>(names.size());
+        toc[i].nameLength = static_cast<std::uint32_t>(sources[i].name.size());
+        toc[i].size = contents[i].size();
+        names += sources[i].name;
+    }
+    header.namesSize = names.size();
+
+    // blobs keep their queue order on disk; only the table is sorted for lookup
+    std::uint64_t offset = alignUp(header.namesOffset + header.namesSize, ASSET_PACK_ALIGNMENT);
+    for (std::size_t i = 0; i < toc.size(); i++)
+    {
+        toc[i].offset = offset;
+        offset = alignUp(offset + toc[i].size, ASSET_PACK_ALIGNMENT);
+    }
+    std::vector<std::size_t> order(toc.size());
+    for (std::size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return toc[a].nameHash < toc[b].nameHash; });
+
+    std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "ERROR::ASSET_PACK::CANNOT_WRITE: " << outputPath << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (std::size_t i : order)
+        out.write(reinterpret_cast<const char*>(&toc[i]), sizeof(AssetPackEntry));
+    out.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+    const std::vector<char> zeros(ASSET_PACK_ALIGNMENT, 0);
+    std::uint64_t written = header.namesOffset + header.namesSize;
+    for (std::size_t i = 0; i < toc.size(); i++)
+    {
+        out.write(zeros.data(), static_cast<std::streamsize>(toc[i].offset - written));
+        out.write(contents[i].data(), static_cast<std::streamsize>(contents[i].size()));
+        written = toc[i].offset + toc[i].size;
+    }
+    // pad the last blob too, so every blob can be mapped as whole pages
+    out.write(zeros.data(), static_cast<std::streamsize>(alignUp(written, ASSET_PACK_ALIGNMENT) - written));
+    return out.good();
+}
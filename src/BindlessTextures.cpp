@@ -0,0 +1,169 @@
+#include"../include/BindlessTextures.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    typedef GLuint64 (APIENTRYP PFNGLGETTEXTUREHANDLEARBPROC)(GLuint texture);
+    typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)(GLuint64 handle);
+    typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)(GLuint64 handle);
+
+    PFNGLGETTEXTUREHANDLEARBPROC getTextureHandle = nullptr;
+    PFNGLMAKETEXTUREHANDLERESIDENTARBPROC makeHandleResident = nullptr;
+    PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC makeHandleNonResident = nullptr;
+    bool supported = false;
+
+    bool hasExtension(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension && std::strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+}
+
+bool bindless::load(GLADloadproc loader)
+{
+    supported = false;
+    if (!hasExtension("GL_ARB_bindless_texture"))
+        return false;
+    getTextureHandle = reinterpret_cast<PFNGLGETTEXTUREHANDLEARBPROC>(loader("glGetTextureHandleARB"));
+    makeHandleResident = reinterpret_cast<PFNGLMAKETEXTUREHANDLERESIDENTARBPROC>(loader("glMakeTextureHandleResidentARB"));
+    makeHandleNonResident = reinterpret_cast<PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC>(loader("glMakeTextureHandleNonResidentARB"));
+    supported = getTextureHandle && makeHandleResident && makeHandleNonResident;
+    return supported;
+}
+
+bool bindless::isSupported()
+{
+    return supported;
+}
+
+BindlessTextureTable::BindlessTextureTable(const TextureHandle& fallback, std::size_t residentBudgetBytes)
+    : handles(MAX_MATERIALS, 0), dirty(true), budget(residentBudgetBytes), bytesResident(0), frame(0)
+{
+    fallbackSlot.texture = fallback;
+    fallbackSlot.handle = getTextureHandle(fallback.id());
+    fallbackSlot.bytes = static_cast<std::size_t>(fallback.width()) * fallback.height() * fallback.channels() * 4 / 3;
+    makeResident(fallbackSlot);
+
+    // std140 pads array elements to 16 bytes, so the shader declares uvec4[MAX_MATERIALS / 2] and each element holds two handles
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, MAX_MATERIALS * sizeof(GLuint64), NULL, GL_DYNAMIC_DRAW);
+}
+
+BindlessTextureTable::~BindlessTextureTable()
+{
+    for (Slot& slot : materials)
+        makeNonResident(slot);
+    makeNonResident(fallbackSlot);
+    glDeleteBuffers(1, &UBO);
+}
+
+int BindlessTextureTable::addMaterial(const TextureHandle& texture)
+{
+    if (materials.size() >= MAX_MATERIALS || !texture)
+    {
+        std::cout << "ERROR::BINDLESS::CANNOT_ADD_MATERIAL" << std::endl;
+        return -1;
+    }
+    Slot slot;
+    slot.texture = texture;
+    // the handle is fixed for the lifetime of the texture, only its residency changes
+    slot.handle = getTextureHandle(texture.id());
+    slot.bytes = static_cast<std::size_t>(texture.width()) * texture.height() * texture.channels() * 4 / 3;
+    materials.push_back(std::move(slot));
+    writeHandle(materials.size() - 1);
+    return static_cast<int>(materials.size()) - 1;
+}
+
+void BindlessTextureTable::beginFrame(std::uint64_t keepFrames)
+{
+    frame++;
+    if (bytesResident <= budget)
+        return;
+    // over budget: drop the least recently requested materials that haven't been used within keepFrames
+    while (bytesResident > budget)
+    {
+        Slot* oldest = nullptr;
+        std::size_t oldestIndex = 0;
+        for (std::size_t i = 0; i < materials.size(); i++)
+        {
+            Slot& slot = materials[i];
+            if (slot.resident && slot.lastRequested + keepFrames < frame && (!oldest || slot.lastRequested < oldest->lastRequested))
+            {
+                oldest = &slot;
+                oldestIndex = i;
+            }
+        }
+        if (!oldest)
+            break;
+        makeNonResident(*oldest);
+        writeHandle(oldestIndex);
+    }
+}
+
+void BindlessTextureTable::request(int material)
+{
+    if (material < 0 || static_cast<std::size_t>(material) >= materials.size())
+        return;
+    Slot& slot = materials[material];
+    slot.lastRequested = frame;
+    if (!slot.resident)
+    {
+        makeResident(slot);
+        writeHandle(material);
+    }
+}
+
+void BindlessTextureTable::bind(unsigned int bindingPoint)
+{
+    if (dirty)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, handles.size() * sizeof(GLuint64), handles.data());
+        dirty = false;
+    }
+    glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, UBO);
+}
+
+void BindlessTextureTable::makeResident(Slot& slot)
+{
+    if (slot.resident || slot.handle == 0)
+        return;
+    // GL rejects making an already resident handle resident again, so only the first slot holding it does
+    if (residentCounts[slot.handle]++ == 0)
+    {
+        makeHandleResident(slot.handle);
+        bytesResident += slot.bytes;
+    }
+    slot.resident = true;
+}
+
+void BindlessTextureTable::makeNonResident(Slot& slot)
+{
+    if (!slot.resident)
+        return;
+    slot.resident = false;
+    std::unordered_map<GLuint64, int>::iterator count = residentCounts.find(slot.handle);
+    if (--count->second > 0)
+        return;
+    residentCounts.erase(count);
+    makeHandleNonResident(slot.handle);
+    bytesResident -= slot.bytes;
+}
+
+void BindlessTextureTable::writeHandle(std::size_t material)
+{
+    // sampling a non-resident handle is undefined, so evicted materials sample the fallback until they're requested again
+    const Slot& slot = materials[material];
+    handles[material] = slot.resident ? slot.handle : fallbackSlot.handle;
+    dirty = true;
+}
@@ -0,0 +1,127 @@
+#include"../include/CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    // cubic Hermite between p1 and p2 over a segment of length dt, with Catmull-Rom tangents taken over the neighbouring span
+    template <typename T>
+    T catmullRom(const T& p0, const T& p1, const T& p2, const T& p3, float t0, float t1, float t2, float t3, float u)
+    {
+        const float dt = t2 - t1;
+        const T m1 = (p2 - p0) * (dt / std::max(t2 - t0, 1e-6f));
+        const T m2 = (p3 - p1) * (dt / std::max(t3 - t1, 1e-6f));
+        const float u2 = u * u;
+        const float u3 = u2 * u;
+        return p1 * (2.0f * u3 - 3.0f * u2 + 1.0f) + m1 * (u3 - 2.0f * u2 + u) + p2 * (-2.0f * u3 + 3.0f * u2) + m2 * (u3 - u2);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// path
+// ---------------------------------------------------------------------------
+
+bool CameraPath::load(const std::string& path)
+{
+    keys.clear();
+    std::ifstream in(path);
+    if (!in)
+    {
+        std::cout << "ERROR::CAMERA_PATH::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line))
+    {
+        lineNumber++;
+        const std::size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+        std::istringstream fields(line);
+        CameraKey key;
+        if (!(fields >> key.time))
+            continue; // blank line
+        if (!(fields >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch >> key.zoom)
+            || (!keys.empty() && key.time <= keys.back().time))
+        {
+            std::cout << "ERROR::CAMERA_PATH::INVALID_KEY: " << path << ":" << lineNumber << std::endl;
+            keys.clear();
+            return false;
+        }
+        keys.push_back(key);
+    }
+    if (keys.size() < 2)
+    {
+        std::cout << "ERROR::CAMERA_PATH::TOO_FEW_KEYS: " << path << std::endl;
+        keys.clear();
+        return false;
+    }
+    return true;
+}
+
+std::size_t CameraPath::sample(float time, CameraKey& out) const
+{
+    const float t = std::min(std::max(time + keys.front().time, keys.front().time), keys.back().time);
+    // the segment whose end is the first key after t; the last segment also takes t == end
+    std::size_t segment = static_cast<std::size_t>(std::upper_bound(keys.begin(), keys.end(), t,
+        [](float value, const CameraKey& key) { return value < key.time; }) - keys.begin());
+    segment = std::min(std::max<std::size_t>(segment, 1), keys.size() - 1) - 1;
+
+    // the end keys stand in for their missing neighbours
+    const CameraKey& k0 = keys[segment == 0 ? 0 : segment - 1];
+    const CameraKey& k1 = keys[segment];
+    const CameraKey& k2 = keys[segment + 1];
+    const CameraKey& k3 = keys[std::min(segment + 2, keys.size() - 1)];
+    const float u = (t - k1.time) / (k2.time - k1.time);
+
+    out.time = t - keys.front().time;
+    out.position = catmullRom(k0.position, k1.position, k2.position, k3.position, k0.time, k1.time, k2.time, k3.time, u);
+    out.yaw = catmullRom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, k0.time, k1.time, k2.time, k3.time, u);
+    out.pitch = catmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, k0.time, k1.time, k2.time, k3.time, u);
+    out.zoom = catmullRom(k0.zoom, k1.zoom, k2.zoom, k3.zoom, k0.time, k1.time, k2.time, k3.time, u);
+    return segment;
+}
+
+// ---------------------------------------------------------------------------
+// stats
+// ---------------------------------------------------------------------------
+
+void CameraPathStats::reset(std::size_t count)
+{
+    segments.assign(count, Segment());
+}
+
+void CameraPathStats::addFrame(std::size_t segment, double milliseconds, std::size_t draws)
+{
+    if (segment >= segments.size())
+        return;
+    Segment& stats = segments[segment];
+    stats.frames++;
+    stats.totalMilliseconds += milliseconds;
+    stats.maxMilliseconds = std::max(stats.maxMilliseconds, milliseconds);
+    stats.draws += draws;
+}
+
+void CameraPathStats::report(const CameraPath& path) const
+{
+    std::cout << "FLYTHROUGH: segment  time(s)         frames  avg ms  max ms  avg draws" << std::endl;
+    for (std::size_t i = 0; i < segments.size(); i++)
+    {
+        const Segment& stats = segments[i];
+        if (stats.frames == 0)
+            continue;
+        std::cout << "FLYTHROUGH: " << std::setw(7) << i << "  " << std::fixed << std::setprecision(2)
+            << std::setw(6) << path.key(i).time << "-" << std::setw(6) << path.key(i + 1).time << "  "
+            << std::setw(6) << stats.frames << "  " << std::setw(6) << stats.totalMilliseconds / stats.frames << "  "
+            << std::setw(6) << stats.maxMilliseconds << "  " << std::setw(9) << std::setprecision(1)
+            << (double)stats.draws / stats.frames << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+}
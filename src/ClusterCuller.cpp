@@ -0,0 +1,62 @@
+#include"../include/ClusterCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+void ClusterCuller::cull(const std::vector<Meshlet>& meshlets, const glm::mat4& model, const Frustum& frustum, const glm::vec3& eye,
+    std::size_t indexSize, std::uint32_t firstIndex, GLint baseVertex)
+{
+    drawCounts.clear();
+    drawOffsets.clear();
+    drawBaseVertices.clear();
+
+    const glm::vec3 axisX = glm::vec3(model[0].x, model[0].y, model[0].z);
+    const glm::vec3 axisY = glm::vec3(model[1].x, model[1].y, model[1].z);
+    const glm::vec3 axisZ = glm::vec3(model[2].x, model[2].y, model[2].z);
+    const float scaleX = glm::length(axisX), scaleY = glm::length(axisY), scaleZ = glm::length(axisZ);
+    const float scale = std::max(scaleX, std::max(scaleY, scaleZ));
+    // the cone test needs normals to transform like positions, which only holds without non-uniform scale
+    const bool uniform = std::fabs(scaleX - scaleY) <= 0.01f * scale && std::fabs(scaleX - scaleZ) <= 0.01f * scale;
+
+    std::size_t rangeEnd = 0;
+    for (const Meshlet& meshlet : meshlets)
+    {
+        totals.tested++;
+        const glm::vec3 local = glm::vec3(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+        const glm::vec4 world = model * glm::vec4(local, 1.0f);
+        const glm::vec3 center = glm::vec3(world.x, world.y, world.z);
+        const float radius = meshlet.radius * scale;
+        if (!frustum.intersectsSphere(center, radius))
+        {
+            totals.frustumCulled++;
+            continue;
+        }
+        if (uniform && meshlet.coneCutoff < 1.0f)
+        {
+            const glm::vec3 localAxis = glm::vec3(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+            const glm::vec3 axis = (axisX * localAxis.x + axisY * localAxis.y + axisZ * localAxis.z) / scale;
+            const glm::vec3 toCenter = center - eye;
+            if (glm::dot(toCenter, axis) >= meshlet.coneCutoff * glm::length(toCenter) + radius)
+            {
+                totals.backfaceCulled++;
+                continue;
+            }
+        }
+
+        totals.visible++;
+        totals.trianglesVisible += meshlet.triangleCount;
+        const GLsizei count = static_cast<GLsizei>(meshlet.triangleCount * 3);
+        if (!drawCounts.empty() && rangeEnd == meshlet.firstIndex)
+        {
+            drawCounts.back() += count;
+        }
+        else
+        {
+            drawCounts.push_back(count);
+            drawOffsets.push_back(reinterpret_cast<const void*>(static_cast<std::size_t>(firstIndex + meshlet.firstIndex) * indexSize));
+            drawBaseVertices.push_back(baseVertex);
+        }
+        rangeEnd = meshlet.firstIndex + meshlet.triangleCount * 3;
+    }
+    totals.draws += drawCounts.size();
+}
@@ -0,0 +1,274 @@
+#include"../include/CommandList.h"
+
+#include <cstring>
+
+namespace
+{
+    struct BindVertexArrayCommand { CommandHeader header; unsigned int vao; };
+    struct UseProgramCommand { CommandHeader header; unsigned int program; };
+    struct BindTextureCommand { CommandHeader header; unsigned int unit; GLenum target; unsigned int texture; };
+    struct UniformMat4Command { CommandHeader header; GLint location; float value[16]; };
+    struct UniformVec3Command { CommandHeader header; GLint location; float value[3]; };
+    struct UniformVec4Command { CommandHeader header; GLint location; float value[4]; };
+    struct UniformIntCommand { CommandHeader header; GLint location; int value; };
+    struct DrawArraysCommand { CommandHeader header; GLenum mode; GLint first; GLsizei count; GLsizei instances; };
+    struct DrawElementsCommand { CommandHeader header; GLenum mode; GLsizei count; GLenum indexType; GLint baseVertex; std::uint64_t offset; GLsizei instances; };
+    // followed by drawCount GLsizei counts, drawCount GLint base vertices and (8-aligned) drawCount 64-bit offsets
+    struct MultiDrawElementsCommand { CommandHeader header; GLenum mode; GLenum indexType; GLsizei drawCount; };
+
+    std::size_t align8(std::size_t size)
+    {
+        return (size + 7) & ~static_cast<std::size_t>(7);
+    }
+
+    std::size_t multiDrawOffsetsStart(GLsizei drawCount)
+    {
+        return align8(sizeof(MultiDrawElementsCommand) + static_cast<std::size_t>(drawCount) * (sizeof(GLsizei) + sizeof(GLint)));
+    }
+}
+
+CommandList::CommandList(std::size_t reserveBytes) : used(0), commandCount(0)
+{
+    arena.resize(reserveBytes);
+}
+
+void* CommandList::allocate(CommandType type, std::size_t size)
+{
+    size = align8(size);
+    if (used + size > arena.size())
+        arena.resize((used + size) * 2);
+    unsigned char* command = arena.data() + used;
+    CommandHeader header = { type, 0, static_cast<std::uint32_t>(size) };
+    std::memcpy(command, &header, sizeof(header));
+    used += size;
+    commandCount++;
+    return command;
+}
+
+// ---------------------------------------------------------------------------
+// recording
+// ---------------------------------------------------------------------------
+
+void CommandList::bindVertexArray(unsigned int vao)
+{
+    static_cast<BindVertexArrayCommand*>(allocate(COMMAND_BIND_VERTEX_ARRAY, sizeof(BindVertexArrayCommand)))->vao = vao;
+}
+
+void CommandList::useProgram(unsigned int program)
+{
+    static_cast<UseProgramCommand*>(allocate(COMMAND_USE_PROGRAM, sizeof(UseProgramCommand)))->program = program;
+}
+
+void CommandList::bindTexture(unsigned int unit, GLenum target, unsigned int texture)
+{
+    BindTextureCommand* command = static_cast<BindTextureCommand*>(allocate(COMMAND_BIND_TEXTURE, sizeof(BindTextureCommand)));
+    command->unit = unit;
+    command->target = target;
+    command->texture = texture;
+}
+
+void CommandList::setMat4(GLint location, const glm::mat4& value)
+{
+    UniformMat4Command* command = static_cast<UniformMat4Command*>(allocate(COMMAND_UNIFORM_MAT4, sizeof(UniformMat4Command)));
+    command->location = location;
+    for (int column = 0; column < 4; column++)
+    {
+        for (int row = 0; row < 4; row++)
+            command->value[column * 4 + row] = value[column][row];
+    }
+}
+
+void CommandList::setVec3(GLint location, const glm::vec3& value)
+{
+    UniformVec3Command* command = static_cast<UniformVec3Command*>(allocate(COMMAND_UNIFORM_VEC3, sizeof(UniformVec3Command)));
+    command->location = location;
+    for (int i = 0; i < 3; i++)
+        command->value[i] = value[i];
+}
+
+void CommandList::setVec4(GLint location, const glm::vec4& value)
+{
+    UniformVec4Command* command = static_cast<UniformVec4Command*>(allocate(COMMAND_UNIFORM_VEC4, sizeof(UniformVec4Command)));
+    command->location = location;
+    for (int i = 0; i < 4; i++)
+        command->value[i] = value[i];
+}
+
+void CommandList::setInt(GLint location, int value)
+{
+    UniformIntCommand* command = static_cast<UniformIntCommand*>(allocate(COMMAND_UNIFORM_INT, sizeof(UniformIntCommand)));
+    command->location = location;
+    command->value = value;
+}
+
+void CommandList::drawArrays(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+{
+    DrawArraysCommand* command = static_cast<DrawArraysCommand*>(allocate(COMMAND_DRAW_ARRAYS, sizeof(DrawArraysCommand)));
+    command->mode = mode;
+    command->first = first;
+    command->count = count;
+    command->instances = instances;
+}
+
+void CommandList::drawElements(GLenum mode, GLsizei count, GLenum indexType, std::size_t offset, GLint baseVertex, GLsizei instances)
+{
+    DrawElementsCommand* command = static_cast<DrawElementsCommand*>(allocate(COMMAND_DRAW_ELEMENTS, sizeof(DrawElementsCommand)));
+    command->mode = mode;
+    command->count = count;
+    command->indexType = indexType;
+    command->baseVertex = baseVertex;
+    command->offset = offset;
+    command->instances = instances;
+}
+
+void CommandList::multiDrawElements(GLenum mode, GLenum indexType, const GLsizei* counts, const void* const* offsets, const GLint* baseVertices, GLsizei drawCount)
+{
+    if (drawCount <= 0)
+        return;
+    const std::size_t offsetsStart = multiDrawOffsetsStart(drawCount);
+    unsigned char* command = static_cast<unsigned char*>(allocate(COMMAND_MULTI_DRAW_ELEMENTS, offsetsStart + drawCount * sizeof(std::uint64_t)));
+    MultiDrawElementsCommand* multi = reinterpret_cast<MultiDrawElementsCommand*>(command);
+    multi->mode = mode;
+    multi->indexType = indexType;
+    multi->drawCount = drawCount;
+    std::memcpy(command + sizeof(MultiDrawElementsCommand), counts, drawCount * sizeof(GLsizei));
+    std::memcpy(command + sizeof(MultiDrawElementsCommand) + drawCount * sizeof(GLsizei), baseVertices, drawCount * sizeof(GLint));
+    std::uint64_t* out = reinterpret_cast<std::uint64_t*>(command + offsetsStart);
+    for (GLsizei i = 0; i < drawCount; i++)
+        out[i] = reinterpret_cast<std::uintptr_t>(offsets[i]);
+}
+
+// ---------------------------------------------------------------------------
+// GL execution
+// ---------------------------------------------------------------------------
+
+CommandExecutor::CommandExecutor() : executed(0), skipped(0), draws(0)
+{
+    invalidate();
+}
+
+void CommandExecutor::invalidate()
+{
+    // ~0 never matches a real object name, so the next bind of anything goes through
+    vertexArray = ~0u;
+    program = ~0u;
+    for (unsigned int& texture : textures)
+        texture = ~0u;
+}
+
+void CommandExecutor::execute(const CommandList& list)
+{
+    const unsigned char* command = list.data();
+    const unsigned char* end = command + list.bytes();
+    while (command < end)
+    {
+        const CommandHeader* header = reinterpret_cast<const CommandHeader*>(command);
+        executed++;
+        switch (header->type)
+        {
+        case COMMAND_BIND_VERTEX_ARRAY:
+        {
+            const BindVertexArrayCommand* bind = reinterpret_cast<const BindVertexArrayCommand*>(command);
+            if (bind->vao != vertexArray)
+            {
+                glBindVertexArray(bind->vao);
+                vertexArray = bind->vao;
+            }
+            else
+            {
+                skipped++;
+            }
+            break;
+        }
+        case COMMAND_USE_PROGRAM:
+        {
+            const UseProgramCommand* use = reinterpret_cast<const UseProgramCommand*>(command);
+            if (use->program != program)
+            {
+                glUseProgram(use->program);
+                program = use->program;
+            }
+            else
+            {
+                skipped++;
+            }
+            break;
+        }
+        case COMMAND_BIND_TEXTURE:
+        {
+            const BindTextureCommand* bind = reinterpret_cast<const BindTextureCommand*>(command);
+            if (bind->unit >= static_cast<unsigned int>(MAX_TEXTURE_UNITS) || textures[bind->unit] != bind->texture)
+            {
+                glActiveTexture(GL_TEXTURE0 + bind->unit);
+                glBindTexture(bind->target, bind->texture);
+                if (bind->unit < static_cast<unsigned int>(MAX_TEXTURE_UNITS))
+                    textures[bind->unit] = bind->texture;
+            }
+            else
+            {
+                skipped++;
+            }
+            break;
+        }
+        case COMMAND_UNIFORM_MAT4:
+        {
+            const UniformMat4Command* uniform = reinterpret_cast<const UniformMat4Command*>(command);
+            glUniformMatrix4fv(uniform->location, 1, GL_FALSE, uniform->value);
+            break;
+        }
+        case COMMAND_UNIFORM_VEC3:
+        {
+            const UniformVec3Command* uniform = reinterpret_cast<const UniformVec3Command*>(command);
+            glUniform3fv(uniform->location, 1, uniform->value);
+            break;
+        }
+        case COMMAND_UNIFORM_VEC4:
+        {
+            const UniformVec4Command* uniform = reinterpret_cast<const UniformVec4Command*>(command);
+            glUniform4fv(uniform->location, 1, uniform->value);
+            break;
+        }
+        case COMMAND_UNIFORM_INT:
+        {
+            const UniformIntCommand* uniform = reinterpret_cast<const UniformIntCommand*>(command);
+            glUniform1i(uniform->location, uniform->value);
+            break;
+        }
+        case COMMAND_DRAW_ARRAYS:
+        {
+            const DrawArraysCommand* draw = reinterpret_cast<const DrawArraysCommand*>(command);
+            if (draw->instances == 1)
+                glDrawArrays(draw->mode, draw->first, draw->count);
+            else
+                glDrawArraysInstanced(draw->mode, draw->first, draw->count, draw->instances);
+            draws++;
+            break;
+        }
+        case COMMAND_DRAW_ELEMENTS:
+        {
+            const DrawElementsCommand* draw = reinterpret_cast<const DrawElementsCommand*>(command);
+            void* offset = reinterpret_cast<void*>(static_cast<std::uintptr_t>(draw->offset));
+            if (draw->instances == 1)
+                glDrawElementsBaseVertex(draw->mode, draw->count, draw->indexType, offset, draw->baseVertex);
+            else
+                glDrawElementsInstancedBaseVertex(draw->mode, draw->count, draw->indexType, offset, draw->instances, draw->baseVertex);
+            draws++;
+            break;
+        }
+        case COMMAND_MULTI_DRAW_ELEMENTS:
+        {
+            const MultiDrawElementsCommand* draw = reinterpret_cast<const MultiDrawElementsCommand*>(command);
+            const GLsizei* counts = reinterpret_cast<const GLsizei*>(command + sizeof(MultiDrawElementsCommand));
+            const GLint* baseVertices = reinterpret_cast<const GLint*>(counts + draw->drawCount);
+            const std::uint64_t* stored = reinterpret_cast<const std::uint64_t*>(command + multiDrawOffsetsStart(draw->drawCount));
+            offsetScratch.resize(draw->drawCount);
+            for (GLsizei i = 0; i < draw->drawCount; i++)
+                offsetScratch[i] = reinterpret_cast<const void*>(static_cast<std::uintptr_t>(stored[i]));
+            glMultiDrawElementsBaseVertex(draw->mode, counts, draw->indexType, offsetScratch.data(), draw->drawCount, baseVertices);
+            draws++;
+            break;
+        }
+        }
+        command += header->size;
+    }
+}
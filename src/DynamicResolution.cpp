@@ -0,0 +1,134 @@
+#include"../include/DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    // weight of the newest sample in the smoothed GPU time
+    const double SMOOTHING = 0.1;
+    // how much of the computed correction is applied per frame
+    const double DAMPING = 0.25;
+    // changes smaller than this are ignored, so the scale settles instead of wobbling by a pixel each frame
+    const float SCALE_DEADBAND = 0.02f;
+}
+
+DynamicResolution::DynamicResolution(double targetMilliseconds, float minScale, float maxScale) : targetMilliseconds(targetMilliseconds),
+    minScale(std::min(minScale, maxScale)), maxScale(std::max(minScale, maxScale)), currentScale(std::max(minScale, maxScale)),
+    smoothedMilliseconds(0.0), outputWidth(0), outputHeight(0), framebuffer(0), colorTexture(0), depthBuffer(0), issued(0), resolved(0),
+    frames(0), scaleSum(0.0), millisecondsSum(0.0)
+{
+    glGenQueries(QUERY_COUNT, queries);
+    glGenFramebuffers(1, &framebuffer);
+    glGenTextures(1, &colorTexture);
+    glGenRenderbuffers(1, &depthBuffer);
+}
+
+DynamicResolution::~DynamicResolution()
+{
+    glDeleteQueries(QUERY_COUNT, queries);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteTextures(1, &colorTexture);
+    glDeleteRenderbuffers(1, &depthBuffer);
+}
+
+void DynamicResolution::setOutputSize(int width, int height)
+{
+    if (width <= 0 || height <= 0 || (width == outputWidth && height == outputHeight))
+        return;
+    outputWidth = width;
+    outputHeight = height;
+
+    // big enough for the largest scale; smaller scales use the lower-left corner
+    const int targetWidth = std::max(1, static_cast<int>(std::ceil(width * maxScale)));
+    const int targetHeight = std::max(1, static_cast<int>(std::ceil(height * maxScale)));
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, targetWidth, targetHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, targetWidth, targetHeight);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::DYNAMIC_RESOLUTION::FRAMEBUFFER_INCOMPLETE" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+int DynamicResolution::renderWidth() const
+{
+    return std::max(1, static_cast<int>(outputWidth * currentScale));
+}
+
+int DynamicResolution::renderHeight() const
+{
+    return std::max(1, static_cast<int>(outputHeight * currentScale));
+}
+
+void DynamicResolution::begin()
+{
+    // a query can only be reused once its result has been read; if the GPU is that far behind, skip timing this frame
+    if (issued - resolved < static_cast<std::uint64_t>(QUERY_COUNT))
+        glBeginQuery(GL_TIME_ELAPSED, queries[issued % QUERY_COUNT]);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, renderWidth(), renderHeight());
+}
+
+void DynamicResolution::end()
+{
+    const bool timed = issued - resolved < static_cast<std::uint64_t>(QUERY_COUNT);
+    if (timed)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        issued++;
+    }
+
+    // upscale into the window; the scene's viewport may be a fraction of the target
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, renderWidth(), renderHeight(), 0, 0, outputWidth, outputHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, outputWidth, outputHeight);
+
+    // read back every query that has finished, oldest first, without waiting on the rest
+    while (resolved < issued)
+    {
+        const unsigned int query = queries[resolved % QUERY_COUNT];
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+        resolved++;
+        adjust(static_cast<double>(nanoseconds) / 1.0e6);
+    }
+    frames++;
+    scaleSum += currentScale;
+}
+
+void DynamicResolution::adjust(double milliseconds)
+{
+    smoothedMilliseconds = smoothedMilliseconds == 0.0 ? milliseconds : smoothedMilliseconds + (milliseconds - smoothedMilliseconds) * SMOOTHING;
+    millisecondsSum += milliseconds;
+    if (smoothedMilliseconds <= 0.0)
+        return;
+
+    // time scales with pixel count, i.e. with scale squared
+    const double ideal = currentScale * std::sqrt(targetMilliseconds / smoothedMilliseconds);
+    const float next = std::min(maxScale, std::max(minScale, static_cast<float>(currentScale + (ideal - currentScale) * DAMPING)));
+    if (std::fabs(next - currentScale) >= SCALE_DEADBAND || next == minScale || next == maxScale)
+        currentScale = next;
+}
+
+void DynamicResolution::report() const
+{
+    if (frames == 0)
+        return;
+    std::cout << "DYNAMIC_RESOLUTION: target " << targetMilliseconds << " ms, average scale " << scaleSum / frames << " (" << minScale << "-"
+        << maxScale << "), average GPU time " << (resolved ? millisecondsSum / resolved : 0.0) << " ms over " << resolved << " timed frames"
+        << std::endl;
+}
@@ -0,0 +1,367 @@
+#include"../include/EntityStore.h"
+#include"../include/JobSystem.h"
+#include"../include/TransformKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+    // rows handed to one job by updateTransforms; a row is a few dozen bytes of input, so this keeps jobs well above their overhead
+    const std::size_t TRANSFORM_GRAIN = 1024;
+
+    template <typename T>
+    void permute(std::vector<T>& column, const std::vector<std::uint32_t>& order)
+    {
+        std::vector<T> sorted;
+        sorted.reserve(column.size());
+        for (std::uint32_t oldRow : order)
+            sorted.push_back(column[oldRow]);
+        column.swap(sorted);
+    }
+}
+
+EntityStore::EntityStore() : levelStarts(1, 0), orderValid(true), anyDirty(false)
+{
+}
+
+Entity EntityStore::create(Entity parent)
+{
+    std::uint32_t index;
+    if (!freeIndices.empty())
+    {
+        index = freeIndices.back();
+        freeIndices.pop_back();
+    }
+    else
+    {
+        index = static_cast<std::uint32_t>(rows.size());
+        rows.push_back(0);
+        generations.push_back(0);
+    }
+
+    const Entity entity = { index, generations[index] };
+    rows[index] = static_cast<std::uint32_t>(entities.size());
+    entities.push_back(entity);
+    positionData.push_back(glm::vec3(0.0f));
+    rotationData.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    scaleData.push_back(glm::vec3(1.0f));
+    localBoundsData.push_back(glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
+    meshIdData.push_back(0);
+    materialIdData.push_back(0);
+    worldData.push_back(glm::mat4(1.0f));
+    worldBoundsData.push_back(glm::vec4(0.0f));
+    visibleData.push_back(1);
+    parentRows.push_back(alive(parent) ? rows[parent.index] : NO_ROW);
+    dirty.push_back(1);
+    changed.push_back(0);
+
+    // a new row at the end breaks up the levels (and a root there would sit after the children of others)
+    orderValid = false;
+    anyDirty = true;
+    return entity;
+}
+
+void EntityStore::destroy(Entity entity)
+{
+    if (!alive(entity))
+        return;
+    const std::uint32_t row = rows[entity.index];
+    const std::uint32_t last = static_cast<std::uint32_t>(entities.size() - 1);
+
+    // orphans become roots; references to the last row follow it into the hole
+    for (std::size_t other = 0; other < parentRows.size(); other++)
+    {
+        if (parentRows[other] == row)
+        {
+            parentRows[other] = NO_ROW;
+            dirty[other] = 1;
+            anyDirty = true;
+        }
+        else if (parentRows[other] == last)
+        {
+            parentRows[other] = row;
+        }
+    }
+
+    if (row != last)
+    {
+        positionData[row] = positionData[last];
+        rotationData[row] = rotationData[last];
+        scaleData[row] = scaleData[last];
+        localBoundsData[row] = localBoundsData[last];
+        meshIdData[row] = meshIdData[last];
+        materialIdData[row] = materialIdData[last];
+        worldData[row] = worldData[last];
+        worldBoundsData[row] = worldBoundsData[last];
+        visibleData[row] = visibleData[last];
+        parentRows[row] = parentRows[last];
+        dirty[row] = dirty[last];
+        changed[row] = changed[last];
+        entities[row] = entities[last];
+        rows[entities[row].index] = row;
+    }
+    positionData.pop_back();
+    rotationData.pop_back();
+    scaleData.pop_back();
+    localBoundsData.pop_back();
+    meshIdData.pop_back();
+    materialIdData.pop_back();
+    worldData.pop_back();
+    worldBoundsData.pop_back();
+    visibleData.pop_back();
+    parentRows.pop_back();
+    dirty.pop_back();
+    changed.pop_back();
+    entities.pop_back();
+
+    rows[entity.index] = NO_ROW;
+    generations[entity.index]++;
+    freeIndices.push_back(entity.index);
+    orderValid = false;
+}
+
+bool EntityStore::alive(Entity entity) const
+{
+    return entity.index < generations.size() && generations[entity.index] == entity.generation;
+}
+
+void EntityStore::clear()
+{
+    while (!entities.empty())
+        destroy(entities.back());
+}
+
+void EntityStore::reserve(std::size_t count)
+{
+    positionData.reserve(count);
+    rotationData.reserve(count);
+    scaleData.reserve(count);
+    localBoundsData.reserve(count);
+    meshIdData.reserve(count);
+    materialIdData.reserve(count);
+    worldData.reserve(count);
+    worldBoundsData.reserve(count);
+    visibleData.reserve(count);
+    parentRows.reserve(count);
+    dirty.reserve(count);
+    changed.reserve(count);
+    entities.reserve(count);
+}
+
+bool EntityStore::setParent(Entity child, Entity parent)
+{
+    if (!alive(child))
+        return false;
+    const std::uint32_t childRow = rows[child.index];
+    std::uint32_t parentRow = NO_ROW;
+    if (alive(parent))
+    {
+        parentRow = rows[parent.index];
+        for (std::uint32_t ancestor = parentRow; ancestor != NO_ROW; ancestor = parentRows[ancestor])
+        {
+            if (ancestor == childRow)
+                return false;
+        }
+    }
+    parentRows[childRow] = parentRow;
+    markDirty(child);
+    orderValid = false;
+    return true;
+}
+
+Entity EntityStore::parent(Entity entity) const
+{
+    if (!alive(entity))
+        return NO_ENTITY;
+    const std::uint32_t parentRow = parentRows[rows[entity.index]];
+    return parentRow == NO_ROW ? NO_ENTITY : entities[parentRow];
+}
+
+void EntityStore::markDirty(Entity entity)
+{
+    // a stale handle's row belongs to another entity by now, or is past the end
+    if (!alive(entity))
+        return;
+    dirty[rows[entity.index]] = 1;
+    anyDirty = true;
+}
+
+void EntityStore::setPosition(Entity entity, const glm::vec3& position)
+{
+    if (!alive(entity))
+        return;
+    positionData[rows[entity.index]] = position;
+    markDirty(entity);
+}
+
+void EntityStore::setRotation(Entity entity, const glm::quat& rotation)
+{
+    if (!alive(entity))
+        return;
+    rotationData[rows[entity.index]] = rotation;
+    markDirty(entity);
+}
+
+void EntityStore::setScale(Entity entity, const glm::vec3& scale)
+{
+    if (!alive(entity))
+        return;
+    scaleData[rows[entity.index]] = scale;
+    markDirty(entity);
+}
+
+void EntityStore::setLocalBounds(Entity entity, const glm::vec4& sphere)
+{
+    if (!alive(entity))
+        return;
+    localBoundsData[rows[entity.index]] = sphere;
+    markDirty(entity);
+}
+
+void EntityStore::sortByDepth()
+{
+    const std::size_t count = entities.size();
+    std::vector<std::uint32_t> depths(count, 0);
+    std::uint32_t maxDepth = 0;
+    for (std::size_t row = 0; row < count; row++)
+    {
+        std::uint32_t depth = 0;
+        for (std::uint32_t ancestor = parentRows[row]; ancestor != NO_ROW; ancestor = parentRows[ancestor])
+            depth++;
+        depths[row] = depth;
+        maxDepth = std::max(maxDepth, depth);
+    }
+
+    // counting sort by depth, stable so rows keep their relative order within a level
+    levelStarts.assign(maxDepth + 2, 0);
+    for (std::uint32_t depth : depths)
+        levelStarts[depth + 1]++;
+    for (std::size_t level = 1; level < levelStarts.size(); level++)
+        levelStarts[level] += levelStarts[level - 1];
+    std::vector<std::size_t> cursor(levelStarts.begin(), levelStarts.end() - 1);
+    std::vector<std::uint32_t> order(count);     // new row -> old row
+    std::vector<std::uint32_t> newRowOf(count);  // old row -> new row
+    for (std::size_t row = 0; row < count; row++)
+    {
+        const std::size_t newRow = cursor[depths[row]]++;
+        order[newRow] = static_cast<std::uint32_t>(row);
+        newRowOf[row] = static_cast<std::uint32_t>(newRow);
+    }
+
+    permute(positionData, order);
+    permute(rotationData, order);
+    permute(scaleData, order);
+    permute(localBoundsData, order);
+    permute(meshIdData, order);
+    permute(materialIdData, order);
+    permute(worldData, order);
+    permute(worldBoundsData, order);
+    permute(visibleData, order);
+    permute(parentRows, order);
+    permute(dirty, order);
+    permute(changed, order);
+    permute(entities, order);
+    for (std::size_t row = 0; row < count; row++)
+    {
+        if (parentRows[row] != NO_ROW)
+            parentRows[row] = newRowOf[parentRows[row]];
+        rows[entities[row].index] = static_cast<std::uint32_t>(row);
+    }
+    orderValid = true;
+}
+
+// ---------------------------------------------------------------------------
+// systems
+// ---------------------------------------------------------------------------
+
+std::size_t EntityStore::updateTransforms(JobSystem& jobs)
+{
+    if (!orderValid)
+        sortByDepth();
+    if (!anyDirty)
+        return 0;
+
+    std::atomic<std::size_t> updated(0);
+    for (std::size_t level = 0; level + 1 < levelStarts.size(); level++)
+    {
+        // a level only reads the one before it, which the previous parallelFor has finished
+        const std::size_t first = levelStarts[level];
+        jobs.parallelFor(levelStarts[level + 1] - first, TRANSFORM_GRAIN, [&](std::size_t begin, std::size_t end) {
+            updated.fetch_add(updateRows(first + begin, first + end), std::memory_order_relaxed);
+        });
+    }
+    anyDirty = false;
+    return updated.load();
+}
+
+std::size_t EntityStore::updateRows(std::size_t begin, std::size_t end)
+{
+    // consecutive roots that need updating are composed as one batch by the SIMD kernel; children need their parent's matrix
+    // multiplied in, so they go one at a time
+    std::size_t updated = 0;
+    std::size_t runStart = begin, runEnd = begin;
+    auto flushRun = [&]() {
+        if (runEnd > runStart)
+            transformkernels::compose(&positionData[runStart], &rotationData[runStart], &scaleData[runStart], runEnd - runStart, &worldData[runStart]);
+        for (std::size_t row = runStart; row < runEnd; row++)
+            updateBounds(row);
+        runStart = runEnd;
+    };
+    for (std::size_t row = begin; row < end; row++)
+    {
+        const std::uint32_t parentRow = parentRows[row];
+        const bool parentChanged = parentRow != NO_ROW && changed[parentRow];
+        if (!dirty[row] && !parentChanged)
+        {
+            changed[row] = 0;
+            continue;
+        }
+        dirty[row] = 0;
+        changed[row] = 1;
+        updated++;
+
+        if (parentRow == NO_ROW)
+        {
+            if (row != runEnd)
+            {
+                flushRun();
+                runStart = row;
+            }
+            runEnd = row + 1;
+            continue;
+        }
+        glm::mat4 local;
+        transformkernels::compose(&positionData[row], &rotationData[row], &scaleData[row], 1, &local);
+        worldData[row] = worldData[parentRow] * local;
+        updateBounds(row);
+    }
+    flushRun();
+    return updated;
+}
+
+void EntityStore::updateBounds(std::size_t row)
+{
+    // the sphere's centre goes through the whole transform; its radius grows with the largest axis scale
+    const glm::mat4& world = worldData[row];
+    const glm::vec4& sphere = localBoundsData[row];
+    const glm::vec4 center = world * glm::vec4(sphere.x, sphere.y, sphere.z, 1.0f);
+    float maxScale = 0.0f;
+    for (int axis = 0; axis < 3; axis++)
+        maxScale = std::max(maxScale, glm::length(glm::vec3(world[axis].x, world[axis].y, world[axis].z)));
+    worldBoundsData[row] = glm::vec4(center.x, center.y, center.z, sphere.w * maxScale);
+}
+
+std::size_t EntityStore::cull(const Frustum& frustum, std::size_t begin, std::size_t end)
+{
+    std::size_t visible = 0;
+    for (std::size_t row = begin; row < end; row++)
+    {
+        const glm::vec4& sphere = worldBoundsData[row];
+        const bool inside = frustum.intersectsSphere(glm::vec3(sphere.x, sphere.y, sphere.z), sphere.w);
+        visibleData[row] = inside ? 1 : 0;
+        visible += inside ? 1 : 0;
+    }
+    return visible;
+}
@@ -0,0 +1,76 @@
+#include"../include/FrameArena.h"
+
+#include <cstdint>
+#include <iostream>
+
+namespace
+{
+    unsigned char* alignUp(unsigned char* pointer, std::size_t alignment)
+    {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(pointer);
+        return pointer + ((alignment - address % alignment) % alignment);
+    }
+}
+
+FrameArena::FrameArena(std::size_t bytesPerFrame) : current(0), peakBytes(0), overflowCount(0), reportPeaks(false)
+{
+    buffers[0].memory.resize(bytesPerFrame);
+    buffers[1].memory.resize(bytesPerFrame);
+}
+
+FrameArena::~FrameArena()
+{
+    for (Buffer& buffer : buffers)
+    {
+        for (void* block : buffer.spilled)
+            ::operator delete(block);
+    }
+}
+
+void FrameArena::beginFrame()
+{
+    const std::size_t lastFrame = used();
+    if (lastFrame > peakBytes)
+    {
+        peakBytes = lastFrame;
+        if (reportPeaks)
+            std::cout << "FRAME_ARENA: new peak " << peakBytes << " bytes per frame (buffer " << capacity() << ")" << std::endl;
+    }
+
+    current = 1 - current;
+    Buffer& buffer = buffers[current];
+    if (!buffer.spilled.empty())
+    {
+        // this buffer was too small last time round: give it room for everything it had to hold, plus some
+        const std::size_t needed = buffer.used + buffer.spilledBytes;
+        for (void* block : buffer.spilled)
+            ::operator delete(block);
+        buffer.spilled.clear();
+        buffer.memory.resize(needed + needed / 2);
+    }
+    buffer.used = 0;
+    buffer.spilledBytes = 0;
+}
+
+void* FrameArena::allocate(std::size_t size, std::size_t alignment)
+{
+    Buffer& buffer = buffers[current];
+    unsigned char* begin = buffer.memory.data();
+    unsigned char* aligned = alignUp(begin + buffer.used, alignment);
+    if (aligned + size <= begin + buffer.memory.size())
+    {
+        buffer.used = static_cast<std::size_t>(aligned + size - begin);
+        return aligned;
+    }
+
+    overflowCount++;
+    unsigned char* block = static_cast<unsigned char*>(::operator new(size + alignment));
+    buffer.spilled.push_back(block);
+    buffer.spilledBytes += size + alignment;
+    return alignUp(block, alignment);
+}
+
+std::size_t FrameArena::used() const
+{
+    return buffers[current].used + buffers[current].spilledBytes;
+}
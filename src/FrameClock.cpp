@@ -0,0 +1,34 @@
+#include"../include/FrameClock.h"
+
+#include <algorithm>
+#include <cmath>
+
+FrameClock::FrameClock(double stepSeconds, int maxSteps) : stepSeconds(stepSeconds), maxSteps(maxSteps), accumulator(0.0), steps(0), dropped(0.0)
+{
+}
+
+int FrameClock::advance(double frameSeconds)
+{
+    accumulator += std::max(frameSeconds, 0.0);
+    int count = 0;
+    while (accumulator >= stepSeconds && count < maxSteps)
+    {
+        accumulator -= stepSeconds;
+        count++;
+    }
+    if (accumulator >= stepSeconds)
+    {
+        // keep the fraction so the blend stays continuous, drop the whole steps that didn't fit
+        const double excess = std::fmod(accumulator, stepSeconds);
+        dropped += accumulator - excess;
+        accumulator = excess;
+    }
+    steps += count;
+    return count;
+}
+
+double FrameClock::interpolatedTime() const
+{
+    // the state being drawn lies between the steps at time() - step and time(); before the second step there is nothing to blend
+    return std::max(0.0, time() - stepSeconds + accumulator);
+}
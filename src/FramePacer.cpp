@@ -0,0 +1,138 @@
+#include"../include/FramePacer.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    // frames kept for the percentiles
+    const std::size_t PACER_SAMPLES = 4096;
+    // how long before the deadline the capped mode stops sleeping and starts spinning; covers a coarse scheduler tick
+    const std::chrono::microseconds SPIN_MARGIN(2000);
+
+    // p in [0, 1] of the first `count` values; sorts a copy
+    float percentile(const std::vector<float>& samples, std::size_t count, float p)
+    {
+        if (count == 0)
+            return 0.0f;
+        std::vector<float> sorted(samples.begin(), samples.begin() + count);
+        const std::size_t index = std::min(count - 1, static_cast<std::size_t>(p * (count - 1) + 0.5f));
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    }
+}
+
+FramePacer::FramePacer() : presentMode(PRESENT_VSYNC), targetRate(0.0), pacing(false), latencies(PACER_SAMPLES), frameIntervals(PACER_SAMPLES),
+    swaps(0), latencySum(0.0), latencyMax(0.0), lastSwap(0.0)
+{
+}
+
+bool FramePacer::parse(const char* mode)
+{
+    if (std::strcmp(mode, "vsync") == 0)
+        presentMode = PRESENT_VSYNC;
+    else if (std::strcmp(mode, "adaptive") == 0)
+        presentMode = PRESENT_ADAPTIVE;
+    else if (std::strcmp(mode, "uncapped") == 0)
+        presentMode = PRESENT_UNCAPPED;
+    else if (std::atof(mode) > 0.0)
+    {
+        presentMode = PRESENT_CAPPED;
+        targetRate = std::atof(mode);
+    }
+    else
+    {
+        std::cout << "ERROR::FRAME_PACER::UNKNOWN_PRESENT_MODE: " << mode << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const char* FramePacer::name() const
+{
+    switch (presentMode)
+    {
+    case PRESENT_VSYNC: return "vsync";
+    case PRESENT_ADAPTIVE: return "adaptive";
+    case PRESENT_UNCAPPED: return "uncapped";
+    case PRESENT_CAPPED: return "capped";
+    }
+    return "unknown";
+}
+
+void FramePacer::apply()
+{
+    int interval = 0;
+    if (presentMode == PRESENT_VSYNC)
+        interval = 1;
+    else if (presentMode == PRESENT_ADAPTIVE)
+    {
+        // late swaps tearing instead of waiting is an extension on both WGL and GLX
+        if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+            interval = -1;
+        else
+        {
+            std::cout << "ERROR::FRAME_PACER::ADAPTIVE_VSYNC_NOT_SUPPORTED: using vsync" << std::endl;
+            presentMode = PRESENT_VSYNC;
+            interval = 1;
+        }
+    }
+    glfwSwapInterval(interval);
+    pacing = false;
+}
+
+void FramePacer::wait()
+{
+    if (presentMode != PRESENT_CAPPED)
+        return;
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetRate));
+    const Clock::time_point now = Clock::now();
+    if (!pacing || now > deadline + period)
+    {
+        // first frame, or more than a frame behind: start the schedule from here rather than rushing to catch up
+        deadline = now + period;
+        pacing = true;
+        return;
+    }
+    if (deadline - now > SPIN_MARGIN)
+        std::this_thread::sleep_until(deadline - SPIN_MARGIN);
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+    deadline += period;
+}
+
+void FramePacer::recordSwap(double inputTime)
+{
+    const double now = glfwGetTime();
+    const float latency = static_cast<float>((now - inputTime) * 1000.0);
+    latencies[swaps % PACER_SAMPLES] = latency;
+    if (swaps > 0)
+        frameIntervals[swaps % PACER_SAMPLES] = static_cast<float>((now - lastSwap) * 1000.0);
+    latencySum += latency;
+    latencyMax = std::max(latencyMax, static_cast<double>(latency));
+    lastSwap = now;
+    swaps++;
+}
+
+void FramePacer::report() const
+{
+    if (swaps < 2)
+        return;
+    const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(swaps, PACER_SAMPLES));
+    // the first swap has no interval; while it is still in the ring, leave its slot out
+    std::vector<float> intervals(frameIntervals.begin(), frameIntervals.begin() + count);
+    if (swaps <= PACER_SAMPLES)
+        intervals.erase(intervals.begin());
+    std::cout << "FRAME_PACING: " << name();
+    if (presentMode == PRESENT_CAPPED)
+        std::cout << " " << targetRate << " fps";
+    std::cout << ", " << swaps << " frames; input-to-swap latency avg " << latencySum / swaps << " ms, p50 "
+        << percentile(latencies, count, 0.5f) << " ms, p99 " << percentile(latencies, count, 0.99f) << " ms, max " << latencyMax
+        << " ms; frame interval p50 " << percentile(intervals, intervals.size(), 0.5f) << " ms, p99 "
+        << percentile(intervals, intervals.size(), 0.99f) << " ms" << std::endl;
+}
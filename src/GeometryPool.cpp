@@ -0,0 +1,245 @@
+#include"../include/GeometryPool.h"
+#include"../include/Mesh.h"
+
+#include <algorithm>
+#include <iostream>
+
+GeometryPool::GeometryPool(std::size_t vertexBytes, std::size_t indexCount, GLenum indexType)
+    : vertexBuffer(0), indexBuffer(0), elementType(indexType), relocations(0), bytesMoved(0)
+{
+    vertexBytes = std::min<std::size_t>(vertexBytes, 0xFFFFFFFFu);
+    indexCount = std::min<std::size_t>(indexCount, 0xFFFFFFFFu / indexSize());
+    vertexAllocator.reset(static_cast<std::uint32_t>(vertexBytes));
+    indexAllocator.reset(static_cast<std::uint32_t>(indexCount));
+
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &indexBuffer);
+    // uploads and copies go through the copy targets so they never disturb whatever VAO or element buffer is bound
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexBytes, NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexCount * indexSize(), NULL, GL_STATIC_DRAW);
+}
+
+GeometryPool::~GeometryPool()
+{
+    for (auto& entry : arrays)
+        glDeleteVertexArrays(1, &entry.second.VAO);
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+}
+
+// ---------------------------------------------------------------------------
+// geometries
+// ---------------------------------------------------------------------------
+
+int GeometryPool::add(const void* vertices, std::size_t vertexCount, const VertexLayout& layout, const void* indices, std::size_t indexCount, std::size_t sourceIndexSize)
+{
+    const std::size_t stride = layout.stride();
+    const std::size_t vertexBytes = vertexCount * stride;
+    if (vertexCount == 0 || indexCount == 0 || vertexBytes > 0xFFFFFFFFu || indexCount > 0xFFFFFFFFu)
+        return -1;
+
+    // indices stay relative to the geometry (baseVertex does the rest), so they only need converting to the pool's width
+    std::vector<std::uint16_t> narrow;
+    std::vector<std::uint32_t> wide;
+    const void* source = indices;
+    if (sourceIndexSize != indexSize())
+    {
+        if (elementType == GL_UNSIGNED_INT)
+        {
+            const std::uint16_t* in = static_cast<const std::uint16_t*>(indices);
+            wide.assign(in, in + indexCount);
+            source = wide.data();
+        }
+        else
+        {
+            if (vertexCount > 0x10000)
+            {
+                std::cout << "ERROR::GEOMETRY_POOL::INDICES_TOO_WIDE: " << vertexCount << " vertices in a 16-bit pool" << std::endl;
+                return -1;
+            }
+            const std::uint32_t* in = static_cast<const std::uint32_t*>(indices);
+            narrow.resize(indexCount);
+            for (std::size_t i = 0; i < indexCount; i++)
+                narrow[i] = static_cast<std::uint16_t>(in[i]);
+            source = narrow.data();
+        }
+    }
+
+    Geometry geometry;
+    geometry.stride = static_cast<std::uint32_t>(stride);
+    if (!reserve(static_cast<std::uint32_t>(vertexBytes), geometry.stride, static_cast<std::uint32_t>(indexCount), geometry))
+    {
+        // holes first, then more room
+        defragment();
+        if (!reserve(static_cast<std::uint32_t>(vertexBytes), geometry.stride, static_cast<std::uint32_t>(indexCount), geometry))
+        {
+            const std::uint64_t vertexCapacity = std::max<std::uint64_t>(2ull * vertexAllocator.capacity(), static_cast<std::uint64_t>(vertexAllocator.capacity()) + vertexBytes + stride);
+            const std::uint64_t indexCapacity = std::max<std::uint64_t>(2ull * indexAllocator.capacity(), static_cast<std::uint64_t>(indexAllocator.capacity()) + indexCount);
+            if (vertexCapacity > 0xFFFFFFFFu || indexCapacity * indexSize() > 0xFFFFFFFFu)
+            {
+                std::cout << "ERROR::GEOMETRY_POOL::OUT_OF_SPACE" << std::endl;
+                return -1;
+            }
+            relocate(static_cast<std::uint32_t>(vertexCapacity), static_cast<std::uint32_t>(indexCapacity));
+            if (!reserve(static_cast<std::uint32_t>(vertexBytes), geometry.stride, static_cast<std::uint32_t>(indexCount), geometry))
+            {
+                std::cout << "ERROR::GEOMETRY_POOL::OUT_OF_SPACE" << std::endl;
+                return -1;
+            }
+        }
+    }
+    geometry.range.vertexCount = static_cast<std::uint32_t>(vertexCount);
+    geometry.range.indexCount = static_cast<std::uint32_t>(indexCount);
+    geometry.live = true;
+    updateRange(geometry);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, geometry.vertexBlock.offset, vertexBytes, vertices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<std::size_t>(geometry.indexBlock.offset) * indexSize(), indexCount * indexSize(), source);
+
+    int id;
+    if (!freeIds.empty())
+    {
+        id = freeIds.back();
+        freeIds.pop_back();
+        geometries[id] = geometry;
+    }
+    else
+    {
+        id = static_cast<int>(geometries.size());
+        geometries.push_back(geometry);
+    }
+    return id;
+}
+
+void GeometryPool::remove(int id)
+{
+    if (id < 0 || id >= static_cast<int>(geometries.size()) || !geometries[id].live)
+        return;
+    vertexAllocator.free(geometries[id].vertexBlock);
+    indexAllocator.free(geometries[id].indexBlock);
+    geometries[id] = Geometry();
+    freeIds.push_back(id);
+}
+
+bool GeometryPool::reserve(std::uint32_t vertexBytes, std::uint32_t stride, std::uint32_t indexCount, Geometry& geometry)
+{
+    geometry.vertexBlock = vertexAllocator.allocate(vertexBytes, stride);
+    if (!geometry.vertexBlock.valid())
+        return false;
+    geometry.indexBlock = indexAllocator.allocate(indexCount);
+    if (!geometry.indexBlock.valid())
+    {
+        vertexAllocator.free(geometry.vertexBlock);
+        geometry.vertexBlock = TlsfAllocation();
+        return false;
+    }
+    return true;
+}
+
+void GeometryPool::updateRange(Geometry& geometry) const
+{
+    geometry.range.baseVertex = static_cast<GLint>(geometry.vertexBlock.offset / geometry.stride);
+    geometry.range.firstIndex = geometry.indexBlock.offset;
+}
+
+// ---------------------------------------------------------------------------
+// compaction
+// ---------------------------------------------------------------------------
+
+void GeometryPool::relocate(std::uint32_t vertexCapacity, std::uint32_t indexCapacity)
+{
+    unsigned int newVertexBuffer, newIndexBuffer;
+    glGenBuffers(1, &newVertexBuffer);
+    glGenBuffers(1, &newIndexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newVertexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity, NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newIndexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<std::size_t>(indexCapacity) * indexSize(), NULL, GL_STATIC_DRAW);
+
+    // refill fresh allocators in address order; allocating from an empty TLSF heap is sequential, so everything ends up packed
+    std::vector<int> order;
+    for (int id = 0; id < static_cast<int>(geometries.size()); id++)
+    {
+        if (geometries[id].live)
+            order.push_back(id);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) { return geometries[a].vertexBlock.offset < geometries[b].vertexBlock.offset; });
+    vertexAllocator.reset(vertexCapacity);
+    indexAllocator.reset(indexCapacity);
+    for (int id : order)
+    {
+        Geometry& geometry = geometries[id];
+        const TlsfAllocation oldVertices = geometry.vertexBlock;
+        const TlsfAllocation oldIndices = geometry.indexBlock;
+        reserve(oldVertices.size, geometry.stride, oldIndices.size, geometry); // can't fail: the new buffers are at least as big
+        glBindBuffer(GL_COPY_READ_BUFFER, vertexBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newVertexBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, oldVertices.offset, geometry.vertexBlock.offset, oldVertices.size);
+        glBindBuffer(GL_COPY_READ_BUFFER, indexBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newIndexBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<std::size_t>(oldIndices.offset) * indexSize(),
+            static_cast<std::size_t>(geometry.indexBlock.offset) * indexSize(), static_cast<std::size_t>(oldIndices.size) * indexSize());
+        updateRange(geometry);
+        bytesMoved += oldVertices.size + static_cast<std::size_t>(oldIndices.size) * indexSize();
+    }
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+    vertexBuffer = newVertexBuffer;
+    indexBuffer = newIndexBuffer;
+    for (auto& entry : arrays)
+        bindArray(entry.second);
+    glBindVertexArray(0);
+    relocations++;
+}
+
+// ---------------------------------------------------------------------------
+// vertex arrays
+// ---------------------------------------------------------------------------
+
+unsigned int GeometryPool::vertexArray(const VertexLayout& layout)
+{
+    auto found = arrays.find(layout.packFormats());
+    if (found != arrays.end())
+        return found->second.VAO;
+    LayoutArray array;
+    glGenVertexArrays(1, &array.VAO);
+    array.layout = layout;
+    bindArray(array);
+    glBindVertexArray(0);
+    arrays[layout.packFormats()] = array;
+    return array.VAO;
+}
+
+void GeometryPool::bindArray(const LayoutArray& array) const
+{
+    glBindVertexArray(array.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    array.layout.apply(MESH_ATTRIB_POSITION, MESH_ATTRIB_TEXCOORD, MESH_ATTRIB_NORMAL);
+}
+
+GeometryPoolStats GeometryPool::stats() const
+{
+    GeometryPoolStats stats;
+    stats.vertices = vertexAllocator.stats();
+    stats.indices = indexAllocator.stats();
+    stats.geometries = geometries.size() - freeIds.size();
+    stats.relocations = relocations;
+    stats.bytesMoved = bytesMoved;
+    return stats;
+}
+
+void GeometryPool::report() const
+{
+    const GeometryPoolStats current = stats();
+    std::cout << "GEOMETRY_POOL: " << current.geometries << " geometries; vertices " << current.vertices.used << "/" << current.vertices.capacity
+        << " bytes in " << current.vertices.allocations << " blocks, " << current.vertices.freeBlocks << " free blocks, largest free "
+        << current.vertices.largestFree << " bytes, fragmentation " << current.vertices.fragmentation() << "; indices " << current.indices.used
+        << "/" << current.indices.capacity << " in " << current.indices.allocations << " blocks, " << current.indices.freeBlocks
+        << " free blocks, largest free " << current.indices.largestFree << ", fragmentation " << current.indices.fragmentation() << "; "
+        << current.relocations << " relocations moved " << current.bytesMoved << " bytes" << std::endl;
+}
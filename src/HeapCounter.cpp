@@ -0,0 +1,89 @@
+#include"../include/HeapCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<std::uint64_t> allocationCount(0);
+    std::atomic<std::uint64_t> allocationBytes(0);
+
+    void* countedAllocate(std::size_t size)
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size ? size : 1);
+    }
+}
+
+std::uint64_t heapcounter::allocations()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+std::uint64_t heapcounter::bytesAllocated()
+{
+    return allocationBytes.load(std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// global operator new/delete replacements. Only the plain forms: over-aligned new keeps the library's own allocator, and with it
+// its matching delete.
+// ---------------------------------------------------------------------------
+
+void* operator new(std::size_t size)
+{
+    void* pointer = countedAllocate(size);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* pointer = countedAllocate(size);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
@@ -0,0 +1,119 @@
+#include"../include/InputLog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// ---------------------------------------------------------------------------
+// recording
+// ---------------------------------------------------------------------------
+
+InputRecorder::InputRecorder() : frameCount(0)
+{
+}
+
+bool InputRecorder::open(const std::string& path)
+{
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "ERROR::INPUT_LOG::CANNOT_WRITE: " << path << std::endl;
+        return false;
+    }
+    InputLogHeader header;
+    std::memcpy(header.magic, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC));
+    header.version = INPUT_LOG_VERSION;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    pending.clear();
+    frameCount = 0;
+    return true;
+}
+
+void InputRecorder::close()
+{
+    if (out.is_open())
+        out.close();
+}
+
+void InputRecorder::mouseMove(float xoffset, float yoffset)
+{
+    if (!out.is_open())
+        return;
+    InputEvent event = {};
+    event.type = INPUT_MOUSE_MOVE;
+    event.x = xoffset;
+    event.y = yoffset;
+    pending.push_back(event);
+}
+
+void InputRecorder::scroll(float yoffset)
+{
+    if (!out.is_open())
+        return;
+    InputEvent event = {};
+    event.type = INPUT_SCROLL;
+    event.y = yoffset;
+    pending.push_back(event);
+}
+
+void InputRecorder::endFrame(float deltaTime, std::uint8_t keys)
+{
+    if (!out.is_open())
+        return;
+    // a frame can't hold more than 65535 events; any beyond that go into the next one, which replays them in the same order
+    const std::size_t count = std::min<std::size_t>(pending.size(), 0xFFFF);
+    InputFrameHeader header = {};
+    header.deltaTime = deltaTime;
+    header.keys = keys;
+    header.eventCount = static_cast<std::uint16_t>(count);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(pending.data()), static_cast<std::streamsize>(count * sizeof(InputEvent)));
+    pending.erase(pending.begin(), pending.begin() + count);
+    frameCount++;
+}
+
+// ---------------------------------------------------------------------------
+// replay
+// ---------------------------------------------------------------------------
+
+InputReplay::InputReplay() : cursor(0), frameCount(0)
+{
+}
+
+bool InputReplay::open(const std::string& path)
+{
+    cursor = 0;
+    frameCount = 0;
+    if (!file.open(path))
+        return false;
+    const InputLogHeader* header = reinterpret_cast<const InputLogHeader*>(file.data());
+    if (file.size() < sizeof(InputLogHeader) || std::memcmp(header->magic, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC)) != 0
+        || header->version != INPUT_LOG_VERSION)
+    {
+        std::cout << "ERROR::INPUT_LOG::INVALID_RECORDING: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    cursor = sizeof(InputLogHeader);
+    return true;
+}
+
+bool InputReplay::next(InputFrame& frame)
+{
+    if (!file.isOpen() || cursor + sizeof(InputFrameHeader) > file.size())
+        return false;
+    InputFrameHeader header;
+    std::memcpy(&header, file.data() + cursor, sizeof(header));
+    const std::size_t eventBytes = header.eventCount * sizeof(InputEvent);
+    if (cursor + sizeof(header) + eventBytes > file.size())
+        return false;
+
+    frame.deltaTime = header.deltaTime;
+    frame.keys = header.keys;
+    frame.events.resize(header.eventCount);
+    if (eventBytes != 0)
+        std::memcpy(frame.events.data(), file.data() + cursor + sizeof(header), eventBytes);
+    cursor += sizeof(header) + eventBytes;
+    frameCount++;
+    return true;
+}
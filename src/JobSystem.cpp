@@ -0,0 +1,348 @@
+#include"../include/JobSystem.h"
+
+struct Job
+{
+    std::function<void()> work;
+    JobCounter* counter;
+    int owner; // worker whose free list it returns to, -1 for the shared list of outside threads
+};
+
+namespace
+{
+    // which system and worker slot the current thread belongs to; -1 for threads the system didn't create
+    thread_local JobSystem* currentSystem = NULL;
+    thread_local int currentIndex = -1;
+    thread_local std::uint32_t stealSeed = 0x9E3779B9u;
+
+    std::uint32_t nextRandom()
+    {
+        stealSeed ^= stealSeed << 13;
+        stealSeed ^= stealSeed >> 17;
+        stealSeed ^= stealSeed << 5;
+        return stealSeed;
+    }
+
+    const int SPINS_BEFORE_SLEEP = 64;
+}
+
+// ---------------------------------------------------------------------------
+// work-stealing deque (Le, Pop, Cohen, Zappa Nardelli: "Correct and Efficient Work-Stealing for Weak Memory Models")
+// ---------------------------------------------------------------------------
+
+WorkStealingDeque::WorkStealingDeque(std::size_t capacity) : top(0), bottom(0)
+{
+    std::size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    slots = std::vector<std::atomic<Job*>>(size);
+    mask = static_cast<std::int64_t>(size) - 1;
+}
+
+bool WorkStealingDeque::push(Job* job)
+{
+    std::int64_t b = bottom.load(std::memory_order_relaxed);
+    std::int64_t t = top.load(std::memory_order_acquire);
+    if (b - t > mask)
+        return false;
+    slots[b & mask].store(job, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release); // publishes the slot to thieves, who read bottom with acquire
+    return true;
+}
+
+Job* WorkStealingDeque::pop()
+{
+    std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b)
+    {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return NULL;
+    }
+    Job* job = slots[b & mask].load(std::memory_order_relaxed);
+    if (t == b)
+    {
+        // last item: race the thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = NULL;
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* WorkStealingDeque::steal()
+{
+    std::int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+        return NULL;
+    Job* job = slots[t & mask].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return NULL;
+    return job;
+}
+
+std::size_t WorkStealingDeque::size() const
+{
+    std::int64_t b = bottom.load(std::memory_order_relaxed);
+    std::int64_t t = top.load(std::memory_order_relaxed);
+    return b > t ? static_cast<std::size_t>(b - t) : 0;
+}
+
+// ---------------------------------------------------------------------------
+// job system
+// ---------------------------------------------------------------------------
+
+JobSystem::JobSystem(unsigned int threadCount) : injectionHead(0), queued(0), sleeping(0), quit(false)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+    for (unsigned int i = 0; i < threadCount; i++)
+        workers.push_back(std::unique_ptr<Worker>(new Worker()));
+
+    currentSystem = this;
+    currentIndex = 0;
+    for (unsigned int i = 1; i < threadCount; i++)
+        workers[i]->thread = std::thread(&JobSystem::workerLoop, this, static_cast<int>(i));
+}
+
+JobSystem::~JobSystem()
+{
+    quit.store(true);
+    {
+        std::lock_guard<std::mutex> lock(sleepLock);
+    }
+    sleepCondition.notify_all();
+    for (std::size_t i = 1; i < workers.size(); i++)
+        workers[i]->thread.join();
+    for (std::unique_ptr<Worker>& worker : workers)
+    {
+        for (Job* job : worker->freeJobs)
+            delete job;
+        for (Job* job : worker->returnedJobs)
+            delete job;
+    }
+    for (Job* job : externalFreeJobs)
+        delete job;
+    if (currentSystem == this)
+    {
+        currentSystem = NULL;
+        currentIndex = -1;
+    }
+}
+
+Job* JobSystem::allocate(std::function<void()> work, JobCounter* counter)
+{
+    Job* job = NULL;
+    const int owner = currentSystem == this ? currentIndex : -1;
+    if (owner >= 0)
+    {
+        std::vector<Job*>& freeJobs = workers[owner]->freeJobs;
+        if (freeJobs.empty())
+        {
+            std::lock_guard<std::mutex> lock(workers[owner]->returnedLock);
+            freeJobs.swap(workers[owner]->returnedJobs);
+        }
+        if (!freeJobs.empty())
+        {
+            job = freeJobs.back();
+            freeJobs.pop_back();
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(injectionLock);
+        if (!externalFreeJobs.empty())
+        {
+            job = externalFreeJobs.back();
+            externalFreeJobs.pop_back();
+        }
+    }
+    if (!job)
+        job = new Job();
+    job->work = std::move(work);
+    job->counter = counter;
+    job->owner = owner;
+    return job;
+}
+
+void JobSystem::recycle(Job* job)
+{
+    job->work = nullptr;
+    if (job->owner < 0)
+    {
+        std::lock_guard<std::mutex> lock(injectionLock);
+        externalFreeJobs.push_back(job);
+    }
+    else if (currentSystem == this && currentIndex == job->owner)
+    {
+        workers[job->owner]->freeJobs.push_back(job);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(workers[job->owner]->returnedLock);
+        workers[job->owner]->returnedJobs.push_back(job);
+    }
+}
+
+void JobSystem::run(std::function<void()> work, JobCounter* counter)
+{
+    if (counter)
+        counter->value.fetch_add(1, std::memory_order_relaxed);
+    submit(allocate(std::move(work), counter));
+}
+
+void JobSystem::runAfter(JobCounter& dependency, std::function<void()> work, JobCounter* counter)
+{
+    if (counter)
+        counter->value.fetch_add(1, std::memory_order_relaxed);
+    Job* job = allocate(std::move(work), counter);
+    {
+        // finish() drops the count to zero under this lock, so the job either sees zero here or is picked up there
+        std::lock_guard<std::mutex> lock(dependency.waitersLock);
+        if (dependency.value.load(std::memory_order_acquire) != 0)
+        {
+            dependency.waiters.push_back(job);
+            return;
+        }
+    }
+    submit(job);
+}
+
+void JobSystem::submit(Job* job)
+{
+    if (currentSystem == this && currentIndex >= 0)
+    {
+        if (!workers[currentIndex]->deque.push(job))
+        {
+            execute(job); // deque full: no point queueing more, just do it
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(injectionLock);
+        // slide the live part down once the consumed front dominates; erasing within capacity never allocates
+        if (injectionHead > 0 && injectionHead * 2 >= injection.size())
+        {
+            injection.erase(injection.begin(), injection.begin() + injectionHead);
+            injectionHead = 0;
+        }
+        injection.push_back(job);
+    }
+    queued.fetch_add(1);
+    wake();
+}
+
+void JobSystem::wake()
+{
+    if (sleeping.load() == 0)
+        return;
+    // taking the lock orders this against a worker that has checked `queued` but not started waiting yet
+    {
+        std::lock_guard<std::mutex> lock(sleepLock);
+    }
+    sleepCondition.notify_one();
+}
+
+void JobSystem::execute(Job* job)
+{
+    job->work();
+    JobCounter* counter = job->counter;
+    recycle(job);
+    finish(counter);
+}
+
+void JobSystem::finish(JobCounter* counter)
+{
+    if (!counter)
+        return;
+    std::vector<Job*> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->waitersLock);
+        if (counter->value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            ready.swap(counter->waiters);
+    }
+    // the counter may be gone by now (its waiter is free to return), only the local list is touched from here on
+    for (Job* job : ready)
+        submit(job);
+}
+
+Job* JobSystem::find(int self)
+{
+    Job* job = NULL;
+    if (self >= 0)
+        job = workers[self]->deque.pop();
+    if (!job)
+    {
+        std::lock_guard<std::mutex> lock(injectionLock);
+        if (injectionHead < injection.size())
+        {
+            job = injection[injectionHead++];
+            if (injectionHead == injection.size())
+            {
+                injection.clear();
+                injectionHead = 0;
+            }
+        }
+    }
+    if (!job)
+    {
+        const std::size_t count = workers.size();
+        const std::size_t start = nextRandom() % count;
+        for (std::size_t i = 0; i < count && !job; i++)
+        {
+            std::size_t victim = (start + i) % count;
+            if (static_cast<int>(victim) != self)
+                job = workers[victim]->deque.steal();
+        }
+    }
+    if (job)
+        queued.fetch_sub(1);
+    return job;
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    const int self = currentSystem == this ? currentIndex : -1;
+    while (!counter.done())
+    {
+        Job* job = find(self);
+        if (job)
+            execute(job);
+        else
+            std::this_thread::yield();
+    }
+    // the last finish() may still be unlocking; don't let the caller destroy the counter under it
+    std::lock_guard<std::mutex> lock(counter.waitersLock);
+}
+
+void JobSystem::workerLoop(int index)
+{
+    currentSystem = this;
+    currentIndex = index;
+    stealSeed ^= static_cast<std::uint32_t>(index) * 0x85EBCA6Bu;
+    int idle = 0;
+    while (!quit.load(std::memory_order_relaxed))
+    {
+        Job* job = find(index);
+        if (job)
+        {
+            execute(job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < SPINS_BEFORE_SLEEP)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepLock);
+        sleeping.fetch_add(1);
+        sleepCondition.wait(lock, [this]() { return queued.load() > 0 || quit.load(); });
+        sleeping.fetch_sub(1);
+        idle = 0;
+    }
+}
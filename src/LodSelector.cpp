@@ -0,0 +1,53 @@
+#include"../include/LodSelector.h"
+
+#include <algorithm>
+#include <cmath>
+
+LodSelector::LodSelector(float pixelThreshold, float hysteresis) : threshold(pixelThreshold), hysteresis(hysteresis), projScale(1.0f)
+{
+}
+
+void LodSelector::setProjection(float fovyRadians, float viewportHeight)
+{
+    // a unit length at distance 1 spans this many pixels vertically
+    projScale = viewportHeight / (2.0f * std::tan(fovyRadians * 0.5f));
+}
+
+float LodSelector::projectedError(float objectError, float distance) const
+{
+    return objectError * projScale / std::max(distance, 1e-4f);
+}
+
+int LodSelector::select(const std::vector<MeshLod>& lods, const glm::vec3& center, float scale, const glm::vec3& cameraPosition, int current) const
+{
+    if (lods.empty())
+        return 0;
+    const float distance = glm::length(center - cameraPosition);
+    const int last = static_cast<int>(lods.size()) - 1;
+
+    // the coarsest level still inside the threshold; errors grow monotonically along the chain
+    int target = 0;
+    for (int i = last; i > 0; i--)
+    {
+        if (projectedError(lods[i].error * scale, distance) <= threshold)
+        {
+            target = i;
+            break;
+        }
+    }
+    // first sighting, or finer than last frame: switch right away
+    if (current < 0 || target <= current)
+        return target;
+    // coarser than last frame: only step down once the error has some margin below the threshold
+    while (target > current && projectedError(lods[target].error * scale, distance) > threshold * (1.0f - hysteresis))
+        target--;
+    return target;
+}
+
+int LodSelector::update(std::size_t object, const std::vector<MeshLod>& lods, const glm::vec3& center, float scale, const glm::vec3& cameraPosition)
+{
+    if (object >= levels.size())
+        levels.resize(object + 1, -1);
+    levels[object] = select(lods, center, scale, cameraPosition, levels[object]);
+    return levels[object];
+}
@@ -0,0 +1,326 @@
+#include"../include/Mesh.h"
+#include"../include/GeometryPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+Mesh::Mesh() : VAO(0), VBO(0), EBO(0), header(), pool(NULL), geometry(-1), chunkSize(0), vertexBytesUploaded(0), indexBytesUploaded(0), ready(false)
+{
+}
+
+Mesh::~Mesh()
+{
+    release();
+}
+
+void Mesh::release()
+{
+    if (VAO)
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+    VAO = VBO = EBO = 0;
+    if (pool)
+        pool->remove(geometry);
+    pool = NULL;
+    geometry = -1;
+    file.close();
+    submeshTable.clear();
+    lodTable.clear();
+    meshletTable.clear();
+    ready = false;
+}
+
+bool Mesh::open(const std::string& path)
+{
+    release();
+    if (!file.open(path))
+        return false;
+
+    bool valid = file.size() >= sizeof(MeshFileHeader);
+    if (valid)
+    {
+        std::memcpy(&header, file.data(), sizeof(MeshFileHeader));
+        valid = std::memcmp(header.magic, MESH_MAGIC, sizeof(MESH_MAGIC)) == 0
+            && header.version == MESH_VERSION
+            && (header.indexSize == 2 || header.indexSize == 4)
+            && file.contains(header.submeshOffset, static_cast<std::uint64_t>(header.submeshCount) * sizeof(MeshSubmesh))
+            && header.lodCount > 0
+            && file.contains(header.lodOffset, static_cast<std::uint64_t>(header.lodCount) * sizeof(MeshLod))
+            && file.contains(header.meshletOffset, static_cast<std::uint64_t>(header.meshletCount) * sizeof(Meshlet))
+            && file.contains(header.vertexOffset, static_cast<std::uint64_t>(header.vertexCount) * header.vertexStride)
+            && file.contains(header.indexOffset, static_cast<std::uint64_t>(header.indexCount) * header.indexSize);
+    }
+    if (!valid)
+    {
+        std::cout << "ERROR::MESH::INVALID_MESH_FILE: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    vertexLayout.unpackFormats(header.vertexFormats);
+    vertexLayout.positionOffset = glm::vec3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+    vertexLayout.positionScale = glm::vec3(header.positionScale[0], header.positionScale[1], header.positionScale[2]);
+    vertexLayout.texCoordTransform = glm::vec4(header.texCoordTransform[0], header.texCoordTransform[1], header.texCoordTransform[2], header.texCoordTransform[3]);
+    if (vertexLayout.stride() != header.vertexStride)
+    {
+        std::cout << "ERROR::MESH::UNKNOWN_VERTEX_LAYOUT: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    const MeshSubmesh* submeshes = reinterpret_cast<const MeshSubmesh*>(file.data() + header.submeshOffset);
+    submeshTable.assign(submeshes, submeshes + header.submeshCount);
+    const MeshLod* lods = reinterpret_cast<const MeshLod*>(file.data() + header.lodOffset);
+    lodTable.assign(lods, lods + header.lodCount);
+    const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(file.data() + header.meshletOffset);
+    meshletTable.assign(meshlets, meshlets + header.meshletCount);
+
+    // the tables fit in the file, but the ranges they hold are drawn straight from the element buffer, so they must fit in it too
+    const std::uint64_t indexCount = header.indexCount;
+    for (const MeshSubmesh& submesh : submeshTable)
+        valid = valid && static_cast<std::uint64_t>(submesh.firstIndex) + submesh.indexCount <= indexCount;
+    for (const MeshLod& lod : lodTable)
+        valid = valid && static_cast<std::uint64_t>(lod.firstIndex) + lod.indexCount <= indexCount
+            && static_cast<std::uint64_t>(lod.firstSubmesh) + lod.submeshCount <= header.submeshCount;
+    for (const Meshlet& meshlet : meshletTable)
+        valid = valid && meshlet.vertexCount <= header.vertexCount && meshlet.submesh < header.submeshCount
+            && static_cast<std::uint64_t>(meshlet.firstIndex) + static_cast<std::uint64_t>(meshlet.triangleCount) * 3 <= indexCount;
+    // and every index must name a vertex that exists, or the GPU fetches past the vertex buffer. One pass over the index data,
+    // which is about to be read for the upload anyway
+    if (valid)
+    {
+        const unsigned char* indices = file.data() + header.indexOffset;
+        std::uint32_t largest = 0;
+        if (header.indexSize == 2)
+        {
+            for (std::uint32_t i = 0; i < header.indexCount; i++)
+            {
+                std::uint16_t index;
+                std::memcpy(&index, indices + i * 2u, sizeof(index));
+                largest = std::max<std::uint32_t>(largest, index);
+            }
+        }
+        else
+        {
+            for (std::uint32_t i = 0; i < header.indexCount; i++)
+            {
+                std::uint32_t index;
+                std::memcpy(&index, indices + static_cast<std::size_t>(i) * 4u, sizeof(index));
+                largest = std::max(largest, index);
+            }
+        }
+        valid = header.indexCount == 0 || largest < header.vertexCount;
+    }
+    if (!valid)
+    {
+        std::cout << "ERROR::MESH::RANGE_OUT_OF_BOUNDS: " << path << std::endl;
+        file.close();
+        submeshTable.clear();
+        lodTable.clear();
+        meshletTable.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool Mesh::beginLoad(const std::string& path, std::size_t streamingBudgetBytes)
+{
+    if (!open(path))
+        return false;
+
+    const std::size_t vertexBytes = static_cast<std::size_t>(header.vertexCount) * header.vertexStride;
+    const std::size_t indexBytes = static_cast<std::size_t>(header.indexCount) * header.indexSize;
+    const bool streamed = vertexBytes + indexBytes > streamingBudgetBytes;
+    chunkSize = streamed ? std::max<std::size_t>(streamingBudgetBytes, 4096) : vertexBytes + indexBytes;
+    vertexBytesUploaded = indexBytesUploaded = 0;
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    if (!streamed)
+    {
+        // the common case: the mapped blocks go straight to the driver, one call per buffer
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, file.data() + header.vertexOffset, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, file.data() + header.indexOffset, GL_STATIC_DRAW);
+        vertexBytesUploaded = vertexBytes;
+        indexBytesUploaded = indexBytes;
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, NULL, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, NULL, GL_STATIC_DRAW);
+    }
+    setupAttributes();
+    glBindVertexArray(0);
+
+    return uploadNext();
+}
+
+bool Mesh::uploadNext()
+{
+    if (ready || !VAO)
+        return ready;
+    const std::size_t vertexBytes = static_cast<std::size_t>(header.vertexCount) * header.vertexStride;
+    const std::size_t indexBytes = static_cast<std::size_t>(header.indexCount) * header.indexSize;
+
+    std::size_t budget = chunkSize;
+    if (vertexBytesUploaded < vertexBytes)
+    {
+        std::size_t size = std::min(budget, vertexBytes - vertexBytesUploaded);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, vertexBytesUploaded, size, file.data() + header.vertexOffset + vertexBytesUploaded);
+        vertexBytesUploaded += size;
+        budget -= size;
+    }
+    if (budget > 0 && indexBytesUploaded < indexBytes)
+    {
+        std::size_t size = std::min(budget, indexBytes - indexBytesUploaded);
+        // GL_ELEMENT_ARRAY_BUFFER binding is VAO state, so go through the VAO rather than disturb whatever is bound
+        glBindVertexArray(VAO);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexBytesUploaded, size, file.data() + header.indexOffset + indexBytesUploaded);
+        glBindVertexArray(0);
+        indexBytesUploaded += size;
+    }
+
+    ready = vertexBytesUploaded == vertexBytes && indexBytesUploaded == indexBytes;
+    if (ready)
+        file.close(); // everything lives in GL buffers now
+    return ready;
+}
+
+bool Mesh::load(const std::string& path, GeometryPool& geometryPool)
+{
+    if (!open(path))
+        return false;
+    geometry = geometryPool.add(file.data() + header.vertexOffset, header.vertexCount, vertexLayout,
+        file.data() + header.indexOffset, header.indexCount, header.indexSize);
+    file.close();
+    if (geometry < 0)
+    {
+        std::cout << "ERROR::MESH::GEOMETRY_POOL_FULL: " << path << std::endl;
+        return false;
+    }
+    pool = &geometryPool;
+    geometryPool.vertexArray(vertexLayout); // create the layout's VAO now, on the GL thread, so recording never has to
+    ready = true;
+    return true;
+}
+
+bool Mesh::load(const std::string& path, std::size_t streamingBudgetBytes)
+{
+    if (!beginLoad(path, streamingBudgetBytes) && !VAO)
+        return false;
+    while (!uploadNext())
+        ;
+    return true;
+}
+
+void Mesh::setupAttributes()
+{
+    vertexLayout.apply(MESH_ATTRIB_POSITION, MESH_ATTRIB_TEXCOORD, MESH_ATTRIB_NORMAL);
+}
+
+void Mesh::applyDequantization(Shader& shader) const
+{
+    shader.use();
+    shader.setVec3("positionOffset", vertexLayout.positionOffset);
+    shader.setVec3("positionScale", vertexLayout.positionScale);
+    shader.setVec4("texCoordTransform", vertexLayout.texCoordTransform);
+}
+
+unsigned int Mesh::vertexArray() const
+{
+    return pool ? pool->vertexArray(vertexLayout) : VAO;
+}
+
+GLenum Mesh::indexType() const
+{
+    if (pool)
+        return pool->indexType();
+    return header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+std::size_t Mesh::indexSize() const
+{
+    return pool ? pool->indexSize() : header.indexSize;
+}
+
+std::uint32_t Mesh::firstIndex() const
+{
+    return pool ? pool->range(geometry).firstIndex : 0;
+}
+
+GLint Mesh::baseVertex() const
+{
+    return pool ? pool->range(geometry).baseVertex : 0;
+}
+
+void Mesh::drawRange(std::uint32_t first, std::uint32_t count, int instanceCount) const
+{
+    if (!ready)
+        return;
+    glBindVertexArray(vertexArray());
+    void* offset = (void*)(static_cast<std::size_t>(firstIndex() + first) * indexSize());
+    if (instanceCount == 1)
+        glDrawElementsBaseVertex(GL_TRIANGLES, count, indexType(), offset, baseVertex());
+    else
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, indexType(), offset, instanceCount, baseVertex());
+}
+
+void Mesh::draw() const
+{
+    drawLod(0);
+}
+
+void Mesh::drawLod(std::size_t lod) const
+{
+    if (lod < lodTable.size())
+        drawRange(lodTable[lod].firstIndex, lodTable[lod].indexCount, 1);
+}
+
+void Mesh::drawClusters(const ClusterCuller& culler) const
+{
+    if (!ready || culler.drawCount() == 0)
+        return;
+    glBindVertexArray(vertexArray());
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, culler.counts().data(), indexType(), culler.offsets().data(), culler.drawCount(), culler.baseVertices().data());
+}
+
+void Mesh::drawSubmesh(std::size_t submesh) const
+{
+    if (submesh < submeshTable.size())
+        drawRange(submeshTable[submesh].firstIndex, submeshTable[submesh].indexCount, 1);
+}
+
+void Mesh::drawInstanced(int instanceCount) const
+{
+    drawLodInstanced(0, instanceCount);
+}
+
+void Mesh::drawLodInstanced(std::size_t lod, int instanceCount) const
+{
+    if (lod < lodTable.size())
+        drawRange(lodTable[lod].firstIndex, lodTable[lod].indexCount, instanceCount);
+}
+
+void Mesh::recordLod(CommandList& commands, std::size_t lod) const
+{
+    if (!ready || lod >= lodTable.size())
+        return;
+    commands.bindVertexArray(vertexArray());
+    commands.drawElements(GL_TRIANGLES, lodTable[lod].indexCount, indexType(), static_cast<std::size_t>(firstIndex() + lodTable[lod].firstIndex) * indexSize(), baseVertex());
+}
+
+void Mesh::recordClusters(CommandList& commands, const ClusterCuller& culler) const
+{
+    if (!ready || culler.drawCount() == 0)
+        return;
+    commands.bindVertexArray(vertexArray());
+    commands.multiDrawElements(GL_TRIANGLES, indexType(), culler.counts().data(), culler.offsets().data(), culler.baseVertices().data(), culler.drawCount());
+}
@@ -0,0 +1,278 @@
+#include"../include/MeshFormat.h"
+#include"../include/Hash.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <unordered_map>
+
+void MeshData::computeBounds()
+{
+    if (vertices.empty())
+    {
+        boundsMin = boundsMax = glm::vec3(0.0f);
+        return;
+    }
+    boundsMin = boundsMax = vertices[0].position;
+    for (const MeshVertex& vertex : vertices)
+    {
+        boundsMin = glm::min(boundsMin, vertex.position);
+        boundsMax = glm::max(boundsMax, vertex.position);
+    }
+}
+
+namespace
+{
+    struct Corner
+    {
+        int position, texCoord, normal;
+        bool operator==(const Corner& other) const { return position == other.position && texCoord == other.texCoord && normal == other.normal; }
+    };
+
+    struct CornerHash
+    {
+        std::size_t operator()(const Corner& corner) const { return static_cast<std::size_t>(fnv1a64(&corner, sizeof(corner))); }
+    };
+
+    const char* skipSpaces(const char* p, const char* end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        return p;
+    }
+
+    const char* nextLine(const char* p, const char* end)
+    {
+        while (p < end && *p != '\n')
+            p++;
+        return p < end ? p + 1 : end;
+    }
+
+    // OBJ indices are 1-based, negative ones count back from the end; 0 means the component is absent
+    int resolveIndex(long index, std::size_t count)
+    {
+        if (index > 0)
+            return static_cast<int>(index - 1);
+        if (index < 0)
+            return static_cast<int>(static_cast<long>(count) + index);
+        return -1;
+    }
+
+    void closeSubmesh(MeshData& mesh)
+    {
+        if (!mesh.submeshes.empty())
+            mesh.submeshes.back().indexCount = static_cast<std::uint32_t>(mesh.indices.size()) - mesh.submeshes.back().firstIndex;
+    }
+
+    void openSubmesh(MeshData& mesh, const std::string& material)
+    {
+        closeSubmesh(mesh);
+        // an empty run (usemtl straight after usemtl) is reused instead of left behind
+        if (!mesh.submeshes.empty() && mesh.submeshes.back().indexCount == 0)
+            mesh.submeshes.pop_back();
+        std::uint32_t materialId = 0;
+        while (materialId < mesh.materialNames.size() && mesh.materialNames[materialId] != material)
+            materialId++;
+        if (materialId == mesh.materialNames.size())
+            mesh.materialNames.push_back(material);
+        mesh.submeshes.push_back(MeshSubmesh{ static_cast<std::uint32_t>(mesh.indices.size()), 0, materialId, 0 });
+    }
+
+    std::uint64_t alignUp(std::uint64_t value, std::uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+bool meshcook::importObj(const std::string& path, MeshData& mesh)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::MESH::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+        return false;
+    }
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> texCoords;
+    std::unordered_map<Corner, std::uint32_t, CornerHash> corners;
+    std::vector<std::uint32_t> polygon;
+
+    mesh = MeshData();
+
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end)
+    {
+        p = skipSpaces(p, end);
+        const char* lineEnd = p;
+        while (lineEnd < end && *lineEnd != '\n' && *lineEnd != '\r')
+            lineEnd++;
+        // numbers are parsed straight out of the file buffer. A short line can't bleed into the next one because every OBJ line starts with a keyword, which stops strtof.
+        if (p + 1 < lineEnd && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            char* next;
+            glm::vec3 v;
+            v.x = std::strtof(p + 2, &next);
+            v.y = std::strtof(next, &next);
+            v.z = std::strtof(next, &next);
+            positions.push_back(v);
+        }
+        else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t'))
+        {
+            char* next;
+            glm::vec2 t;
+            t.x = std::strtof(p + 3, &next);
+            t.y = std::strtof(next, &next);
+            texCoords.push_back(t);
+        }
+        else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t'))
+        {
+            char* next;
+            glm::vec3 n;
+            n.x = std::strtof(p + 3, &next);
+            n.y = std::strtof(next, &next);
+            n.z = std::strtof(next, &next);
+            normals.push_back(n);
+        }
+        else if (p + 1 < lineEnd && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            // faces before the first usemtl go into a default submesh
+            if (mesh.submeshes.empty())
+                openSubmesh(mesh, "");
+            polygon.clear();
+            const char* q = p + 2;
+            while (true)
+            {
+                q = skipSpaces(q, lineEnd);
+                if (q >= lineEnd)
+                    break;
+                char* next;
+                Corner corner{ -1, -1, -1 };
+                corner.position = resolveIndex(std::strtol(q, &next, 10), positions.size());
+                q = next;
+                if (q < lineEnd && *q == '/')
+                {
+                    q++;
+                    if (q < lineEnd && *q != '/')
+                    {
+                        corner.texCoord = resolveIndex(std::strtol(q, &next, 10), texCoords.size());
+                        q = next;
+                    }
+                    if (q < lineEnd && *q == '/')
+                    {
+                        corner.normal = resolveIndex(std::strtol(q + 1, &next, 10), normals.size());
+                        q = next;
+                    }
+                }
+                if (corner.position < 0 || corner.position >= static_cast<int>(positions.size()))
+                {
+                    std::cout << "ERROR::MESH::BAD_FACE_INDEX: " << path << std::endl;
+                    return false;
+                }
+                auto found = corners.find(corner);
+                if (found == corners.end())
+                {
+                    MeshVertex vertex;
+                    vertex.position = positions[corner.position];
+                    vertex.texCoord = (corner.texCoord >= 0 && corner.texCoord < static_cast<int>(texCoords.size())) ? texCoords[corner.texCoord] : glm::vec2(0.0f);
+                    vertex.normal = (corner.normal >= 0 && corner.normal < static_cast<int>(normals.size())) ? normals[corner.normal] : glm::vec3(0.0f);
+                    found = corners.emplace(corner, static_cast<std::uint32_t>(mesh.vertices.size())).first;
+                    mesh.vertices.push_back(vertex);
+                }
+                polygon.push_back(found->second);
+                while (q < lineEnd && *q != ' ' && *q != '\t')
+                    q++;
+            }
+            for (std::size_t i = 2; i < polygon.size(); i++)
+            {
+                mesh.indices.push_back(polygon[0]);
+                mesh.indices.push_back(polygon[i - 1]);
+                mesh.indices.push_back(polygon[i]);
+            }
+        }
+        else if (lineEnd - p > 7 && std::strncmp(p, "usemtl", 6) == 0)
+        {
+            const char* name = skipSpaces(p + 6, lineEnd);
+            openSubmesh(mesh, std::string(name, lineEnd));
+        }
+        p = nextLine(lineEnd, end);
+    }
+    closeSubmesh(mesh);
+    if (!mesh.submeshes.empty() && mesh.submeshes.back().indexCount == 0)
+        mesh.submeshes.pop_back();
+    mesh.computeBounds();
+    return true;
+}
+
+bool meshcook::writeMesh(const std::string& path, const MeshData& mesh)
+{
+    return writeMesh(path, mesh, vertexlayout::choose(mesh));
+}
+
+bool meshcook::writeMesh(const std::string& path, const MeshData& mesh, const VertexLayout& layout)
+{
+    std::vector<unsigned char> vertexBytes;
+    vertexlayout::encode(mesh, layout, vertexBytes);
+    std::vector<MeshLod> lods(mesh.lods);
+    if (lods.empty())
+        lods.push_back(MeshLod{ 0, static_cast<std::uint32_t>(mesh.indices.size()), 0, static_cast<std::uint32_t>(mesh.submeshes.size()), 0.0f, 0 });
+
+    MeshFileHeader header;
+    std::memcpy(header.magic, MESH_MAGIC, sizeof(MESH_MAGIC));
+    header.version = MESH_VERSION;
+    header.vertexCount = static_cast<std::uint32_t>(mesh.vertices.size());
+    header.vertexStride = static_cast<std::uint32_t>(layout.stride());
+    header.indexCount = static_cast<std::uint32_t>(mesh.indices.size());
+    header.indexSize = mesh.vertices.size() <= 0xFFFF ? 2 : 4;
+    header.submeshCount = static_cast<std::uint32_t>(mesh.submeshes.size());
+    header.lodCount = static_cast<std::uint32_t>(lods.size());
+    header.meshletCount = static_cast<std::uint32_t>(mesh.meshlets.size());
+    header.vertexFormats = layout.packFormats();
+    for (int i = 0; i < 3; i++)
+    {
+        header.boundsMin[i] = mesh.boundsMin[i];
+        header.boundsMax[i] = mesh.boundsMax[i];
+        header.positionOffset[i] = layout.positionOffset[i];
+        header.positionScale[i] = layout.positionScale[i];
+    }
+    for (int i = 0; i < 4; i++)
+        header.texCoordTransform[i] = layout.texCoordTransform[i];
+    header.submeshOffset = sizeof(MeshFileHeader);
+    header.lodOffset = header.submeshOffset + mesh.submeshes.size() * sizeof(MeshSubmesh);
+    header.meshletOffset = header.lodOffset + lods.size() * sizeof(MeshLod);
+    header.vertexOffset = alignUp(header.meshletOffset + mesh.meshlets.size() * sizeof(Meshlet), 16);
+    header.indexOffset = alignUp(header.vertexOffset + static_cast<std::uint64_t>(header.vertexCount) * header.vertexStride, 16);
+
+    std::vector<char> bytes(static_cast<std::size_t>(header.indexOffset + static_cast<std::uint64_t>(header.indexCount) * header.indexSize), 0);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    if (!mesh.submeshes.empty())
+        std::memcpy(&bytes[header.submeshOffset], mesh.submeshes.data(), mesh.submeshes.size() * sizeof(MeshSubmesh));
+    std::memcpy(&bytes[header.lodOffset], lods.data(), lods.size() * sizeof(MeshLod));
+    if (!mesh.meshlets.empty())
+        std::memcpy(&bytes[header.meshletOffset], mesh.meshlets.data(), mesh.meshlets.size() * sizeof(Meshlet));
+    if (!vertexBytes.empty())
+        std::memcpy(&bytes[header.vertexOffset], vertexBytes.data(), vertexBytes.size());
+    if (header.indexSize == 2)
+    {
+        std::uint16_t* out = reinterpret_cast<std::uint16_t*>(&bytes[header.indexOffset]);
+        for (std::size_t i = 0; i < mesh.indices.size(); i++)
+            out[i] = static_cast<std::uint16_t>(mesh.indices[i]);
+    }
+    else if (!mesh.indices.empty())
+    {
+        std::memcpy(&bytes[header.indexOffset], mesh.indices.data(), mesh.indices.size() * sizeof(std::uint32_t));
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "ERROR::MESH::CANNOT_WRITE: " << path << std::endl;
+        return false;
+    }
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return out.good();
+}
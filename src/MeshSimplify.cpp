@@ -0,0 +1,313 @@
+#include"../include/MeshFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+    // symmetric 4x4 error quadric, stored as its upper triangle
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+        void addPlane(double a, double b, double c, double d, double weight)
+        {
+            a2 += weight * a * a; ab += weight * a * b; ac += weight * a * c; ad += weight * a * d;
+            b2 += weight * b * b; bc += weight * b * c; bd += weight * b * d;
+            c2 += weight * c * c; cd += weight * c * d;
+            d2 += weight * d * d;
+        }
+
+        Quadric& operator+=(const Quadric& q)
+        {
+            a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2; bc += q.bc; bd += q.bd; c2 += q.c2; cd += q.cd; d2 += q.d2;
+            return *this;
+        }
+
+        // sum of squared distances from p to every plane folded into the quadric
+        double evaluate(const glm::vec3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            double error = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                + c2 * z * z + 2 * cd * z + d2;
+            return error > 0 ? error : 0;
+        }
+    };
+
+    struct Collapse
+    {
+        double cost;
+        std::uint32_t from, to;
+        std::uint32_t fromVersion, toVersion;
+        bool operator<(const Collapse& other) const { return cost > other.cost; } // min-heap
+    };
+
+    struct PositionHash
+    {
+        std::size_t operator()(const glm::vec3& p) const
+        {
+            std::uint32_t bits[3];
+            std::memcpy(bits, &p, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+
+    struct PositionEqual
+    {
+        bool operator()(const glm::vec3& a, const glm::vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+    };
+
+    glm::vec3 triangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        return glm::cross(b - a, c - a);
+    }
+}
+
+float meshcook::simplify(const std::vector<MeshVertex>& vertices, const std::vector<std::uint32_t>& indices, const std::vector<std::uint32_t>& triangleSubmesh,
+    std::size_t targetTriangles, float maxError, std::vector<std::uint32_t>& outIndices, std::vector<std::uint32_t>& outTriangleSubmesh)
+{
+    const std::size_t vertexCount = vertices.size();
+    const std::size_t triangleCount = indices.size() / 3;
+    std::vector<std::uint32_t> tris(indices);
+    std::vector<bool> triangleRemoved(triangleCount, false);
+    std::vector<std::vector<std::uint32_t>> vertexTriangles(vertexCount);
+    std::vector<Quadric> quadrics(vertexCount);
+    std::vector<std::uint32_t> version(vertexCount, 0);
+    std::vector<bool> alive(vertexCount, true);
+    std::vector<bool> locked(vertexCount, false);
+
+    // vertices split along UV or normal seams share a position; collapsing one side without the other would open a crack
+    std::unordered_map<glm::vec3, std::uint32_t, PositionHash, PositionEqual> firstAtPosition;
+    std::vector<bool> used(vertexCount, false);
+    for (std::uint32_t index : indices)
+        used[index] = true;
+    for (std::uint32_t v = 0; v < vertexCount; v++)
+    {
+        if (!used[v])
+            continue;
+        auto inserted = firstAtPosition.emplace(vertices[v].position, v);
+        if (!inserted.second)
+            locked[v] = locked[inserted.first->second] = true;
+    }
+
+    // face quadrics, and adjacency
+    std::unordered_map<std::uint64_t, int> edgeUse;
+    auto edgeKey = [](std::uint32_t a, std::uint32_t b) { return a < b ? (static_cast<std::uint64_t>(a) << 32) | b : (static_cast<std::uint64_t>(b) << 32) | a; };
+    for (std::size_t t = 0; t < triangleCount; t++)
+    {
+        const std::uint32_t* tri = &tris[t * 3];
+        glm::vec3 n = triangleNormal(vertices[tri[0]].position, vertices[tri[1]].position, vertices[tri[2]].position);
+        float length = glm::length(n);
+        if (length > 0.0f)
+        {
+            n = n / length;
+            double d = -glm::dot(n, vertices[tri[0]].position);
+            for (int i = 0; i < 3; i++)
+                quadrics[tri[i]].addPlane(n.x, n.y, n.z, d, 1.0);
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            vertexTriangles[tri[i]].push_back(static_cast<std::uint32_t>(t));
+            edgeUse[edgeKey(tri[i], tri[(i + 1) % 3])]++;
+        }
+    }
+    // border edges get a plane perpendicular to the face so the outline keeps its shape
+    for (std::size_t t = 0; t < triangleCount; t++)
+    {
+        const std::uint32_t* tri = &tris[t * 3];
+        glm::vec3 n = triangleNormal(vertices[tri[0]].position, vertices[tri[1]].position, vertices[tri[2]].position);
+        for (int i = 0; i < 3; i++)
+        {
+            std::uint32_t a = tri[i], b = tri[(i + 1) % 3];
+            if (edgeUse[edgeKey(a, b)] != 1)
+                continue;
+            glm::vec3 edge = vertices[b].position - vertices[a].position;
+            glm::vec3 borderNormal = glm::cross(edge, n);
+            float length = glm::length(borderNormal);
+            if (length <= 0.0f)
+                continue;
+            borderNormal = borderNormal / length;
+            double d = -glm::dot(borderNormal, vertices[a].position);
+            quadrics[a].addPlane(borderNormal.x, borderNormal.y, borderNormal.z, d, 10.0);
+            quadrics[b].addPlane(borderNormal.x, borderNormal.y, borderNormal.z, d, 10.0);
+        }
+    }
+
+    std::priority_queue<Collapse> heap;
+    auto pushCollapse = [&](std::uint32_t from, std::uint32_t to)
+    {
+        if (locked[from])
+            return;
+        Quadric q = quadrics[from];
+        q += quadrics[to];
+        heap.push(Collapse{ q.evaluate(vertices[to].position), from, to, version[from], version[to] });
+    };
+    for (std::size_t t = 0; t < triangleCount; t++)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            std::uint32_t a = tris[t * 3 + i], b = tris[t * 3 + (i + 1) % 3];
+            pushCollapse(a, b);
+            pushCollapse(b, a);
+        }
+    }
+
+    const double maxCost = static_cast<double>(maxError) * maxError;
+    double worstCost = 0.0;
+    std::size_t liveTriangles = triangleCount;
+    while (liveTriangles > targetTriangles && !heap.empty())
+    {
+        Collapse collapse = heap.top();
+        heap.pop();
+        const std::uint32_t u = collapse.from, v = collapse.to;
+        if (!alive[u] || !alive[v] || collapse.fromVersion != version[u] || collapse.toVersion != version[v])
+            continue;
+        if (collapse.cost > maxCost)
+            break;
+
+        // the edge has to still exist, and moving u onto v must not fold any remaining triangle over
+        bool connected = false, flips = false;
+        for (std::uint32_t t : vertexTriangles[u])
+        {
+            const std::uint32_t* tri = &tris[t * 3];
+            if (tri[0] == v || tri[1] == v || tri[2] == v)
+            {
+                connected = true;
+                continue;
+            }
+            glm::vec3 p[3], moved[3];
+            for (int i = 0; i < 3; i++)
+            {
+                p[i] = vertices[tri[i]].position;
+                moved[i] = tri[i] == u ? vertices[v].position : p[i];
+            }
+            glm::vec3 before = triangleNormal(p[0], p[1], p[2]);
+            glm::vec3 after = triangleNormal(moved[0], moved[1], moved[2]);
+            if (glm::dot(before, after) <= 0.1f * glm::length(before) * glm::length(after))
+            {
+                flips = true;
+                break;
+            }
+        }
+        if (!connected || flips)
+            continue;
+
+        for (std::uint32_t t : vertexTriangles[u])
+        {
+            std::uint32_t* tri = &tris[t * 3];
+            if (tri[0] == v || tri[1] == v || tri[2] == v)
+            {
+                // the triangles on the collapsed edge disappear
+                triangleRemoved[t] = true;
+                liveTriangles--;
+                for (int i = 0; i < 3; i++)
+                {
+                    if (tri[i] == u)
+                        continue;
+                    std::vector<std::uint32_t>& list = vertexTriangles[tri[i]];
+                    list.erase(std::remove(list.begin(), list.end(), t), list.end());
+                }
+            }
+            else
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    if (tri[i] == u)
+                        tri[i] = v;
+                }
+                vertexTriangles[v].push_back(t);
+            }
+        }
+        vertexTriangles[u].clear();
+        alive[u] = false;
+        quadrics[v] += quadrics[u];
+        version[v]++;
+        worstCost = std::max(worstCost, collapse.cost);
+
+        for (std::uint32_t t : vertexTriangles[v])
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                std::uint32_t w = tris[t * 3 + i];
+                if (w == v)
+                    continue;
+                pushCollapse(w, v);
+                pushCollapse(v, w);
+            }
+        }
+    }
+
+    outIndices.clear();
+    outTriangleSubmesh.clear();
+    for (std::size_t t = 0; t < triangleCount; t++)
+    {
+        if (triangleRemoved[t])
+            continue;
+        outIndices.insert(outIndices.end(), &tris[t * 3], &tris[t * 3] + 3);
+        outTriangleSubmesh.push_back(triangleSubmesh[t]);
+    }
+    return static_cast<float>(std::sqrt(worstCost));
+}
+
+void meshcook::generateLods(MeshData& mesh, const LodSettings& settings)
+{
+    if (mesh.lods.empty())
+        mesh.lods.push_back(MeshLod{ 0, static_cast<std::uint32_t>(mesh.indices.size()), 0, static_cast<std::uint32_t>(mesh.submeshes.size()), 0.0f, 0 });
+
+    const float diagonal = glm::length(mesh.boundsMax - mesh.boundsMin);
+    const float maxError = settings.maxError * (diagonal > 0.0f ? diagonal : 1.0f);
+
+    // start from the finest level, remembering which submesh each triangle belongs to
+    const MeshLod base = mesh.lods[0];
+    std::vector<std::uint32_t> current(mesh.indices.begin() + base.firstIndex, mesh.indices.begin() + base.firstIndex + base.indexCount);
+    std::vector<std::uint32_t> currentSubmesh;
+    for (std::uint32_t s = base.firstSubmesh; s < base.firstSubmesh + base.submeshCount; s++)
+        currentSubmesh.insert(currentSubmesh.end(), mesh.submeshes[s].indexCount / 3, s - base.firstSubmesh);
+    float error = 0.0f;
+
+    while (static_cast<int>(mesh.lods.size()) < settings.maxLods)
+    {
+        const std::size_t triangles = current.size() / 3;
+        const std::size_t target = static_cast<std::size_t>(triangles * settings.reduction);
+        if (target < settings.minTriangles)
+            break;
+        std::vector<std::uint32_t> simplified, simplifiedSubmesh;
+        float levelError = simplify(mesh.vertices, current, currentSubmesh, target, maxError, simplified, simplifiedSubmesh);
+        // stop once simplification stalls (everything left is locked or too costly)
+        if (simplified.size() / 3 > triangles * (1.0f + settings.reduction) / 2.0f)
+            break;
+        // errors accumulate from level to level
+        error += levelError;
+
+        MeshLod lod;
+        lod.firstIndex = static_cast<std::uint32_t>(mesh.indices.size());
+        lod.firstSubmesh = static_cast<std::uint32_t>(mesh.submeshes.size());
+        lod.submeshCount = 0;
+        for (std::uint32_t s = 0; s < base.submeshCount; s++)
+        {
+            MeshSubmesh submesh = mesh.submeshes[base.firstSubmesh + s];
+            submesh.firstIndex = static_cast<std::uint32_t>(mesh.indices.size());
+            for (std::size_t t = 0; t < simplifiedSubmesh.size(); t++)
+            {
+                if (simplifiedSubmesh[t] == s)
+                    mesh.indices.insert(mesh.indices.end(), &simplified[t * 3], &simplified[t * 3] + 3);
+            }
+            submesh.indexCount = static_cast<std::uint32_t>(mesh.indices.size()) - submesh.firstIndex;
+            if (submesh.indexCount == 0)
+                continue;
+            mesh.submeshes.push_back(submesh);
+            lod.submeshCount++;
+        }
+        lod.indexCount = static_cast<std::uint32_t>(mesh.indices.size()) - lod.firstIndex;
+        lod.error = error;
+        lod.reserved = 0;
+        mesh.lods.push_back(lod);
+
+        current.swap(simplified);
+        currentSubmesh.swap(simplifiedSubmesh);
+    }
+}
@@ -0,0 +1,193 @@
+#include"../include/MeshFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // a meshlet being grown: its triangles, and its vertices marked in a shared array to keep membership tests O(1)
+    struct MeshletBuild
+    {
+        std::vector<std::uint32_t> triangles;
+        std::vector<std::uint32_t> vertices;
+        glm::vec3 positionSum = glm::vec3(0.0f);
+    };
+
+    void computeBounds(const MeshData& mesh, const std::vector<std::uint32_t>& tris, const MeshletBuild& build, Meshlet& meshlet)
+    {
+        glm::vec3 lo = mesh.vertices[build.vertices[0]].position, hi = lo;
+        for (std::uint32_t v : build.vertices)
+        {
+            lo = glm::min(lo, mesh.vertices[v].position);
+            hi = glm::max(hi, mesh.vertices[v].position);
+        }
+        glm::vec3 center = (lo + hi) * 0.5f;
+        float radius = 0.0f;
+        for (std::uint32_t v : build.vertices)
+            radius = std::max(radius, glm::length(mesh.vertices[v].position - center));
+
+        // normal cone from the face normals; the spread is the widest angle any face makes with the average
+        glm::vec3 normals = glm::vec3(0.0f);
+        std::vector<glm::vec3> faceNormals;
+        faceNormals.reserve(build.triangles.size());
+        for (std::uint32_t t : build.triangles)
+        {
+            const glm::vec3& a = mesh.vertices[tris[t * 3]].position;
+            const glm::vec3& b = mesh.vertices[tris[t * 3 + 1]].position;
+            const glm::vec3& c = mesh.vertices[tris[t * 3 + 2]].position;
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float length = glm::length(n);
+            if (length <= 0.0f)
+                continue;
+            faceNormals.push_back(n / length);
+            normals = normals + n / length;
+        }
+        glm::vec3 axis = glm::vec3(0.0f);
+        float cutoff = 1.0f;
+        float axisLength = glm::length(normals);
+        if (axisLength > 1e-6f && !faceNormals.empty())
+        {
+            axis = normals / axisLength;
+            float minDot = 1.0f;
+            for (const glm::vec3& n : faceNormals)
+                minDot = std::min(minDot, glm::dot(n, axis));
+            // every face within acos(minDot) of the axis: the cluster is back-facing once the view direction is within
+            // 90 degrees minus that of the axis, i.e. dot(view, axis) >= sin(acos(minDot))
+            if (minDot > 0.0f)
+                cutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+
+        for (int i = 0; i < 3; i++)
+        {
+            meshlet.center[i] = center[i];
+            meshlet.coneAxis[i] = axis[i];
+        }
+        meshlet.radius = radius;
+        meshlet.coneCutoff = cutoff;
+    }
+}
+
+void meshcook::buildMeshlets(MeshData& mesh, std::size_t maxVertices, std::size_t maxTriangles)
+{
+    mesh.meshlets.clear();
+    const std::uint32_t endSubmesh = mesh.lods.empty() ? static_cast<std::uint32_t>(mesh.submeshes.size()) : mesh.lods[0].firstSubmesh + mesh.lods[0].submeshCount;
+    const std::uint32_t firstSubmesh = mesh.lods.empty() ? 0 : mesh.lods[0].firstSubmesh;
+    const std::size_t vertexCount = mesh.vertices.size();
+
+    std::vector<std::uint32_t> meshletOf(vertexCount, std::numeric_limits<std::uint32_t>::max());
+    std::vector<std::uint32_t> adjacencyStart(vertexCount + 1);
+    std::vector<std::uint32_t> adjacency;
+    std::vector<std::uint32_t> remaining(vertexCount);
+
+    for (std::uint32_t s = firstSubmesh; s < endSubmesh; s++)
+    {
+        const MeshSubmesh& submesh = mesh.submeshes[s];
+        const std::vector<std::uint32_t> tris(mesh.indices.begin() + submesh.firstIndex, mesh.indices.begin() + submesh.firstIndex + submesh.indexCount);
+        const std::uint32_t triangleCount = submesh.indexCount / 3;
+
+        // vertex -> triangle adjacency for this submesh, flattened
+        std::fill(adjacencyStart.begin(), adjacencyStart.end(), 0);
+        for (std::uint32_t index : tris)
+            adjacencyStart[index + 1]++;
+        for (std::size_t v = 0; v < vertexCount; v++)
+            adjacencyStart[v + 1] += adjacencyStart[v];
+        adjacency.assign(tris.size(), 0);
+        std::vector<std::uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (std::uint32_t t = 0; t < triangleCount; t++)
+        {
+            for (int i = 0; i < 3; i++)
+                adjacency[fill[tris[t * 3 + i]]++] = t;
+        }
+        for (std::size_t v = 0; v < vertexCount; v++)
+            remaining[v] = adjacencyStart[v + 1] - adjacencyStart[v];
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<std::uint32_t> reordered;
+        reordered.reserve(tris.size());
+        std::uint32_t seed = 0;
+        while (true)
+        {
+            while (seed < triangleCount && emitted[seed])
+                seed++;
+            if (seed == triangleCount)
+                break;
+
+            const std::uint32_t id = static_cast<std::uint32_t>(mesh.meshlets.size());
+            MeshletBuild build;
+            std::uint32_t next = seed;
+            while (true)
+            {
+                // take the triangle
+                emitted[next] = true;
+                build.triangles.push_back(next);
+                for (int i = 0; i < 3; i++)
+                {
+                    std::uint32_t v = tris[next * 3 + i];
+                    remaining[v]--;
+                    if (meshletOf[v] != id)
+                    {
+                        meshletOf[v] = id;
+                        build.vertices.push_back(v);
+                        build.positionSum = build.positionSum + mesh.vertices[v].position;
+                    }
+                }
+                if (build.triangles.size() >= maxTriangles)
+                    break;
+
+                // next candidate: the neighbouring triangle that adds the fewest new vertices, preferring ones that finish off
+                // vertices with few triangles left (so no slivers are stranded), then ones closest to the meshlet's centre
+                const glm::vec3 centroid = build.positionSum / static_cast<float>(build.vertices.size());
+                std::uint32_t best = triangleCount;
+                int bestNew = 4;
+                std::uint32_t bestRemaining = std::numeric_limits<std::uint32_t>::max();
+                float bestDistance = std::numeric_limits<float>::max();
+                for (std::uint32_t v : build.vertices)
+                {
+                    if (remaining[v] == 0)
+                        continue;
+                    for (std::uint32_t a = adjacencyStart[v]; a < adjacencyStart[v + 1]; a++)
+                    {
+                        std::uint32_t t = adjacency[a];
+                        if (emitted[t])
+                            continue;
+                        int added = 0;
+                        std::uint32_t left = 0;
+                        glm::vec3 triangleCenter = glm::vec3(0.0f);
+                        for (int i = 0; i < 3; i++)
+                        {
+                            std::uint32_t w = tris[t * 3 + i];
+                            added += meshletOf[w] != id ? 1 : 0;
+                            left += remaining[w];
+                            triangleCenter = triangleCenter + mesh.vertices[w].position;
+                        }
+                        if (build.vertices.size() + added > maxVertices)
+                            continue;
+                        float distance = glm::length(triangleCenter / 3.0f - centroid);
+                        if (added < bestNew || (added == bestNew && (left < bestRemaining || (left == bestRemaining && distance < bestDistance))))
+                        {
+                            best = t;
+                            bestNew = added;
+                            bestRemaining = left;
+                            bestDistance = distance;
+                        }
+                    }
+                }
+                if (best == triangleCount)
+                    break; // full, or nothing connected left: start a new meshlet at the next unused triangle
+                next = best;
+            }
+
+            Meshlet meshlet;
+            meshlet.firstIndex = submesh.firstIndex + static_cast<std::uint32_t>(reordered.size());
+            meshlet.triangleCount = static_cast<std::uint32_t>(build.triangles.size());
+            meshlet.vertexCount = static_cast<std::uint32_t>(build.vertices.size());
+            meshlet.submesh = s;
+            computeBounds(mesh, tris, build, meshlet);
+            mesh.meshlets.push_back(meshlet);
+            for (std::uint32_t t : build.triangles)
+                reordered.insert(reordered.end(), &tris[t * 3], &tris[t * 3] + 3);
+        }
+        std::copy(reordered.begin(), reordered.end(), mesh.indices.begin() + submesh.firstIndex);
+    }
+}
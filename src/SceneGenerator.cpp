@@ -0,0 +1,189 @@
+#include"../include/SceneGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace
+{
+    // city: lots per block side, the street between blocks (in lots) and the tallest tower
+    const std::size_t CITY_BLOCK_LOTS = 4;
+    const std::size_t CITY_STREET_LOTS = 1;
+    const std::uint32_t CITY_MAX_FLOORS = 12;
+
+    // floats built from the raw generator output, so they are the same with every standard library
+    class Random
+    {
+    public:
+        explicit Random(std::uint32_t seed) : engine(seed) {}
+
+        // [0, 1)
+        float unit() { return static_cast<float>(engine() >> 8) * (1.0f / 16777216.0f); }
+        float range(float low, float high) { return low + (high - low) * unit(); }
+        std::uint32_t below(std::uint32_t count) { return count <= 1 ? 0 : static_cast<std::uint32_t>(engine() % count); }
+        // roughly normal, mean 0 and standard deviation 1 (the sum of three uniforms, which is cheap and bounded)
+        float bell() { return (unit() + unit() + unit() - 1.5f) * 2.0f; }
+
+        glm::vec3 direction()
+        {
+            const float z = range(-1.0f, 1.0f);
+            const float angle = range(0.0f, 6.2831853f);
+            const float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            return glm::vec3(r * std::cos(angle), r * std::sin(angle), z);
+        }
+
+        // uniformly distributed rotation (Shoemake)
+        glm::quat rotation()
+        {
+            const float u1 = unit(), u2 = unit() * 6.2831853f, u3 = unit() * 6.2831853f;
+            const float a = std::sqrt(1.0f - u1), b = std::sqrt(u1);
+            return glm::quat(a * std::cos(u2), a * std::sin(u2), b * std::sin(u3), b * std::cos(u3));
+        }
+
+    private:
+        std::mt19937 engine;
+    };
+
+    struct Placement
+    {
+        glm::vec3 position;
+        glm::quat rotation;
+        glm::vec3 scale;
+    };
+
+    // the city is laid out a tower at a time; this walks the lots in order, and the floors of each
+    struct CityCursor
+    {
+        std::size_t lotsPerSide;
+        std::size_t lot = 0;
+        std::uint32_t floor = 0;
+        std::uint32_t floors = 0;
+    };
+}
+
+namespace scenegen
+{
+    bool parseLayout(const char* name, Layout& layout)
+    {
+        const Layout layouts[] = { GRID, RANDOM, CLUSTERED, CITY };
+        for (Layout candidate : layouts)
+        {
+            if (std::strcmp(name, layoutName(candidate)) == 0)
+            {
+                layout = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char* layoutName(Layout layout)
+    {
+        switch (layout)
+        {
+        case GRID: return "grid";
+        case RANDOM: return "random";
+        case CLUSTERED: return "clustered";
+        case CITY: return "city";
+        }
+        return "unknown";
+    }
+
+    void generate(const Settings& settings, const glm::vec4* meshBounds, EntityStore& scene, std::vector<Spinner>& spinners)
+    {
+        Random random(settings.seed);
+        const std::size_t count = settings.count;
+        const float spacing = settings.spacing;
+        // side of the volume that holds `count` objects `spacing` apart
+        const float extent = spacing * std::cbrt(static_cast<float>(std::max<std::size_t>(count, 1)));
+
+        // layout state that has to exist before the first object
+        const std::size_t gridSide = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+        std::vector<glm::vec3> clusterCenters;
+        float clusterRadius = 0.0f;
+        if (settings.layout == CLUSTERED)
+        {
+            const std::size_t clusters = std::max<std::size_t>(1, static_cast<std::size_t>(std::sqrt(static_cast<double>(count))) / 4);
+            for (std::size_t i = 0; i < clusters; i++)
+                clusterCenters.push_back(glm::vec3(random.bell(), random.bell(), random.bell()) * extent);
+            clusterRadius = spacing * 0.5f * std::cbrt(static_cast<float>(count) / clusters);
+        }
+        CityCursor city;
+        const float lotPitch = spacing * 0.5f;
+        {
+            // enough lots for towers of average height, in whole blocks
+            const std::size_t lots = count / (CITY_MAX_FLOORS / 2) + 1;
+            const std::size_t blocks = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(lots)) / CITY_BLOCK_LOTS));
+            city.lotsPerSide = std::max<std::size_t>(blocks, 1) * CITY_BLOCK_LOTS;
+        }
+        const float citySide = (city.lotsPerSide + (city.lotsPerSide / CITY_BLOCK_LOTS) * CITY_STREET_LOTS) * lotPitch;
+
+        scene.reserve(scene.size() + count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            Placement placement = { glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f) };
+            switch (settings.layout)
+            {
+            case GRID:
+            {
+                const float half = (gridSide - 1) * 0.5f;
+                placement.position = glm::vec3((i % gridSide - half) * spacing, 0.0f, (i / gridSide - half) * spacing);
+                break;
+            }
+            case RANDOM:
+                placement.position = glm::vec3(random.range(-0.5f, 0.5f), random.range(-0.5f, 0.5f), random.range(-0.5f, 0.5f)) * extent;
+                placement.rotation = random.rotation();
+                placement.scale = glm::vec3(random.range(0.5f, 1.5f));
+                break;
+            case CLUSTERED:
+            {
+                const glm::vec3& center = clusterCenters[random.below(static_cast<std::uint32_t>(clusterCenters.size()))];
+                placement.position = center + glm::vec3(random.bell(), random.bell(), random.bell()) * clusterRadius;
+                placement.rotation = random.rotation();
+                placement.scale = glm::vec3(random.range(0.5f, 1.5f));
+                break;
+            }
+            case CITY:
+            {
+                if (city.floor == city.floors)
+                {
+                    // next lot, next tower
+                    if (city.floors != 0)
+                        city.lot++;
+                    city.floor = 0;
+                    city.floors = 1 + random.below(CITY_MAX_FLOORS);
+                }
+                const std::size_t lotX = city.lot % city.lotsPerSide;
+                const std::size_t lotZ = city.lot / city.lotsPerSide;
+                const float x = (lotX + (lotX / CITY_BLOCK_LOTS) * CITY_STREET_LOTS) * lotPitch - citySide * 0.5f;
+                const float z = (lotZ + (lotZ / CITY_BLOCK_LOTS) * CITY_STREET_LOTS) * lotPitch - citySide * 0.5f;
+                placement.position = glm::vec3(x, static_cast<float>(city.floor), z);
+                placement.scale = glm::vec3(0.9f, 1.0f, 0.9f);
+                city.floor++;
+                break;
+            }
+            }
+
+            const std::uint32_t meshId = random.below(settings.meshCount);
+            const std::uint32_t materialId = random.below(settings.materialCount);
+            const bool dynamic = random.unit() < settings.dynamicFraction;
+
+            const Entity entity = scene.create();
+            scene.setPosition(entity, placement.position);
+            scene.setRotation(entity, placement.rotation);
+            scene.setScale(entity, placement.scale);
+            scene.setLocalBounds(entity, meshBounds[meshId]);
+            scene.meshIds()[scene.row(entity)] = meshId;
+            scene.materialIds()[scene.row(entity)] = materialId;
+            if (dynamic)
+                spinners.push_back(Spinner{ entity, placement.rotation, random.direction(), random.range(0.5f, 2.0f) });
+        }
+    }
+
+    void animate(const std::vector<Spinner>& spinners, float time, EntityStore& scene)
+    {
+        for (const Spinner& spinner : spinners)
+            scene.setRotation(spinner.entity, glm::angleAxis(time * spinner.speed, spinner.axis) * spinner.rest);
+    }
+}
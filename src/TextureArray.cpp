@@ -0,0 +1,97 @@
+#include"../include/TextureArray.h"
+#include"../include/stb_image.h"
+
+#include <iostream>
+
+TextureArray::TextureArray(int width, int height, int layers, const TextureOptions& options) : layerWidth(width), layerHeight(height), layerCount(layers), nextLayer(0), options(options)
+{
+    glGenTextures(1, &ID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, options.wrapS);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, options.wrapT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, options.minFilter);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, options.magFilter);
+    // allocate every layer up front, the layers are filled with glTexSubImage3D
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+}
+
+TextureArray::~TextureArray()
+{
+    glDeleteTextures(1, &ID);
+}
+
+int TextureArray::addLayer(const std::string& path)
+{
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load(options.flipVertically);
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4); // always expand to RGBA so every layer has the same format
+    return addDecoded(path, data, width, height);
+}
+
+int TextureArray::addLayer(const std::string& name, const unsigned char* encoded, std::size_t size)
+{
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load(options.flipVertically);
+    unsigned char* data = stbi_load_from_memory(encoded, static_cast<int>(size), &width, &height, &channels, 4);
+    return addDecoded(name, data, width, height);
+}
+
+int TextureArray::addDecoded(const std::string& name, unsigned char* data, int width, int height)
+{
+    if (!data)
+    {
+        std::cout << "ERROR::TEXTURE_ARRAY::FILE_NOT_SUCCESSFULLY_READ: " << name << std::endl;
+        return -1;
+    }
+    if (nextLayer >= layerCount)
+    {
+        std::cout << "ERROR::TEXTURE_ARRAY::FULL: " << name << std::endl;
+        stbi_image_free(data);
+        return -1;
+    }
+    if (width != layerWidth || height != layerHeight)
+    {
+        std::cout << "ERROR::TEXTURE_ARRAY::SIZE_MISMATCH: " << name << " is " << width << "x" << height
+            << ", layers are " << layerWidth << "x" << layerHeight << " (use TextureAtlasBuilder for mixed sizes)" << std::endl;
+        stbi_image_free(data);
+        return -1;
+    }
+    int layer = addLayer(data);
+    stbi_image_free(data);
+    return layer;
+}
+
+int TextureArray::addLayer(const unsigned char* rgba)
+{
+    if (nextLayer >= layerCount)
+        return -1;
+    setRegion(nextLayer, 0, 0, layerWidth, layerHeight, rgba);
+    return nextLayer++;
+}
+
+void TextureArray::setRegion(int layer, int x, int y, int regionWidth, int regionHeight, const unsigned char* rgba)
+{
+    glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, layer, regionWidth, regionHeight, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+}
+
+void TextureArray::generateMipmaps()
+{
+    if (!options.generateMipmaps)
+        return;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+
+void TextureArray::bind(unsigned int unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+}
+
+TextureRegion TextureArray::region(int layer) const
+{
+    TextureRegion region;
+    region.layer = static_cast<float>(layer);
+    return region;
+}
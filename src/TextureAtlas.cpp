@@ -0,0 +1,205 @@
+#include"../include/TextureAtlas.h"
+#include"../include/stb_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// RectPacker
+// ------------------------------------------------------------------------
+RectPacker::RectPacker(int pageSize) : size(pageSize), usedArea(0)
+{
+    reset();
+}
+
+void RectPacker::reset()
+{
+    skyline.assign(1, Segment{ 0, 0, size });
+    usedArea = 0;
+}
+
+int RectPacker::fitAt(std::size_t i, int w, int h) const
+{
+    if (skyline[i].x + w > size)
+        return -1;
+    int y = 0;
+    int remaining = w;
+    for (std::size_t j = i; remaining > 0; j++)
+    {
+        if (j >= skyline.size())
+            return -1;
+        y = std::max(y, skyline[j].y);
+        if (y + h > size)
+            return -1;
+        remaining -= skyline[j].width;
+    }
+    return y;
+}
+
+bool RectPacker::insert(int w, int h, int& x, int& y)
+{
+    // pick the position with the lowest top edge, ties broken by the narrowest segment
+    int bestY = size + 1, bestWidth = size + 1;
+    std::size_t bestIndex = skyline.size();
+    for (std::size_t i = 0; i < skyline.size(); i++)
+    {
+        int fitY = fitAt(i, w, h);
+        if (fitY < 0)
+            continue;
+        if (fitY + h < bestY || (fitY + h == bestY && skyline[i].width < bestWidth))
+        {
+            bestY = fitY + h;
+            bestWidth = skyline[i].width;
+            bestIndex = i;
+        }
+    }
+    if (bestIndex == skyline.size())
+        return false;
+
+    x = skyline[bestIndex].x;
+    y = bestY - h;
+
+    // raise the skyline under the new rectangle
+    Segment placed{ x, bestY, w };
+    skyline.insert(skyline.begin() + bestIndex, placed);
+    for (std::size_t i = bestIndex + 1; i < skyline.size();)
+    {
+        Segment& previous = skyline[i - 1];
+        Segment& current = skyline[i];
+        int overlap = previous.x + previous.width - current.x;
+        if (overlap <= 0)
+            break;
+        current.x += overlap;
+        current.width -= overlap;
+        if (current.width <= 0)
+            skyline.erase(skyline.begin() + i);
+        else
+            break;
+    }
+    // merge neighbours at the same height
+    for (std::size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+            i++;
+    }
+    usedArea += static_cast<long long>(w) * h;
+    return true;
+}
+
+float RectPacker::occupancy() const
+{
+    return static_cast<float>(usedArea) / (static_cast<float>(size) * size);
+}
+
+// TextureAtlasBuilder
+// ------------------------------------------------------------------------
+TextureAtlasBuilder::TextureAtlasBuilder(int pageSize, int padding) : pageSize(pageSize), padding(padding)
+{
+}
+
+int TextureAtlasBuilder::add(const std::string& path)
+{
+    paths.push_back(path);
+    return static_cast<int>(paths.size()) - 1;
+}
+
+std::unique_ptr<TextureArray> TextureAtlasBuilder::build(std::vector<TextureRegion>& regions, const TextureOptions& options)
+{
+    struct Image
+    {
+        unsigned char* pixels = nullptr;
+        int width = 0, height = 0;
+        int page = -1, x = 0, y = 0;
+    };
+    std::vector<Image> images(paths.size());
+    regions.assign(paths.size(), TextureRegion());
+
+    stbi_set_flip_vertically_on_load(options.flipVertically);
+    for (std::size_t i = 0; i < paths.size(); i++)
+    {
+        int channels;
+        images[i].pixels = stbi_load(paths[i].c_str(), &images[i].width, &images[i].height, &channels, 4);
+        if (!images[i].pixels)
+            std::cout << "ERROR::TEXTURE_ATLAS::FILE_NOT_SUCCESSFULLY_READ: " << paths[i] << std::endl;
+        else if (images[i].width + 2 * padding > pageSize || images[i].height + 2 * padding > pageSize)
+        {
+            std::cout << "ERROR::TEXTURE_ATLAS::IMAGE_LARGER_THAN_PAGE: " << paths[i] << std::endl;
+            stbi_image_free(images[i].pixels);
+            images[i].pixels = nullptr;
+        }
+    }
+
+    // tallest first packs noticeably tighter with a skyline packer
+    std::vector<std::size_t> order(images.size());
+    for (std::size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return images[a].height > images[b].height; });
+
+    std::vector<RectPacker> pages;
+    for (std::size_t i : order)
+    {
+        Image& image = images[i];
+        if (!image.pixels)
+            continue;
+        const int w = image.width + 2 * padding, h = image.height + 2 * padding;
+        for (std::size_t p = 0; p <= pages.size() && image.page < 0; p++)
+        {
+            if (p == pages.size())
+                pages.emplace_back(pageSize);
+            if (pages[p].insert(w, h, image.x, image.y))
+                image.page = static_cast<int>(p);
+        }
+    }
+
+    std::unique_ptr<TextureArray> atlas(new TextureArray(pageSize, pageSize, std::max<int>(1, static_cast<int>(pages.size())), options));
+
+    // compose each page on the CPU, with the gutters filled by clamping to the image edge, then upload it in one call
+    std::vector<unsigned char> page(static_cast<std::size_t>(pageSize) * pageSize * 4);
+    for (std::size_t p = 0; p < pages.size(); p++)
+    {
+        std::fill(page.begin(), page.end(), static_cast<unsigned char>(0));
+        for (const Image& image : images)
+        {
+            if (image.page != static_cast<int>(p))
+                continue;
+            const int w = image.width + 2 * padding, h = image.height + 2 * padding;
+            for (int row = 0; row < h; row++)
+            {
+                int srcRow = std::min(std::max(row - padding, 0), image.height - 1);
+                unsigned char* dst = &page[(static_cast<std::size_t>(image.y + row) * pageSize + image.x) * 4];
+                const unsigned char* src = &image.pixels[static_cast<std::size_t>(srcRow) * image.width * 4];
+                for (int col = 0; col < padding; col++)
+                    std::memcpy(dst + col * 4, src, 4);
+                std::memcpy(dst + padding * 4, src, static_cast<std::size_t>(image.width) * 4);
+                for (int col = padding + image.width; col < w; col++)
+                    std::memcpy(dst + col * 4, src + (image.width - 1) * 4, 4);
+            }
+        }
+        atlas->addLayer(page.data());
+    }
+    atlas->generateMipmaps();
+
+    for (std::size_t i = 0; i < images.size(); i++)
+    {
+        Image& image = images[i];
+        if (image.page < 0)
+        {
+            regions[i].layer = -1.0f;
+        }
+        else
+        {
+            regions[i].layer = static_cast<float>(image.page);
+            regions[i].uvRect = glm::vec4(
+                static_cast<float>(image.x + padding) / pageSize, static_cast<float>(image.y + padding) / pageSize,
+                static_cast<float>(image.width) / pageSize, static_cast<float>(image.height) / pageSize);
+        }
+        if (image.pixels)
+            stbi_image_free(image.pixels);
+    }
+    return atlas;
+}
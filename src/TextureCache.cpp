@@ -0,0 +1,418 @@
+#include"../include/TextureCache.h"
+#include"../include/Hash.h"
+#include"../include/stb_image.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+namespace
+{
+    // canonical form of a path so "assets/../assets/a.png" and "assets/a.png" share one entry
+    std::string canonicalPath(const std::string& path)
+    {
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+        if (ec)
+            return path;
+        return canonical.generic_string();
+    }
+
+    bool readFile(const std::string& path, std::vector<unsigned char>& bytes)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+        std::streamsize size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        bytes.resize(static_cast<std::size_t>(size));
+        return size == 0 || file.read(reinterpret_cast<char*>(bytes.data()), size).good();
+    }
+
+    GLenum formatForChannels(int channels)
+    {
+        switch (channels)
+        {
+        case 1: return GL_RED;
+        case 2: return GL_RG;
+        case 3: return GL_RGB;
+        default: return GL_RGBA;
+        }
+    }
+
+    // create the texture's storage under an existing name; runs on whichever thread owns the uploading context
+    void uploadPixels(unsigned int id, int width, int height, GLenum format, const unsigned char* data, const TextureOptions& options)
+    {
+        glBindTexture(GL_TEXTURE_2D, id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, options.wrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, options.wrapT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, options.minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, options.magFilter);
+        // rows of 1-3 channel images aren't necessarily 4-byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (options.generateMipmaps)
+            glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
+std::string TextureOptions::key() const
+{
+    std::ostringstream ss;
+    ss << wrapS << ',' << wrapT << ',' << minFilter << ',' << magFilter << ',' << generateMipmaps << ',' << flipVertically << ',' << desiredChannels;
+    return ss.str();
+}
+
+// TextureHandle
+// ------------------------------------------------------------------------
+TextureHandle::TextureHandle() : cache(nullptr), slot(0), generation(0)
+{
+}
+
+TextureHandle::TextureHandle(TextureCache* cache, std::size_t slot, std::uint32_t generation) : cache(cache), slot(slot), generation(generation)
+{
+}
+
+TextureHandle::TextureHandle(const TextureHandle& other) : cache(other.cache), slot(other.slot), generation(other.generation)
+{
+    if (cache)
+        cache->addRef(slot, generation);
+}
+
+TextureHandle::TextureHandle(TextureHandle&& other) noexcept : cache(other.cache), slot(other.slot), generation(other.generation)
+{
+    other.cache = nullptr;
+}
+
+TextureHandle& TextureHandle::operator=(TextureHandle other) noexcept
+{
+    std::swap(cache, other.cache);
+    std::swap(slot, other.slot);
+    std::swap(generation, other.generation);
+    return *this;
+}
+
+TextureHandle::~TextureHandle()
+{
+    if (cache)
+        cache->release(slot, generation);
+}
+
+unsigned int TextureHandle::id() const
+{
+    const TextureCache::Entry* entry = cache ? cache->lookup(slot, generation) : nullptr;
+    return entry && entry->uploaded ? entry->id : 0;
+}
+
+int TextureHandle::width() const
+{
+    const TextureCache::Entry* entry = cache ? cache->lookup(slot, generation) : nullptr;
+    return entry ? entry->width : 0;
+}
+
+int TextureHandle::height() const
+{
+    const TextureCache::Entry* entry = cache ? cache->lookup(slot, generation) : nullptr;
+    return entry ? entry->height : 0;
+}
+
+int TextureHandle::channels() const
+{
+    const TextureCache::Entry* entry = cache ? cache->lookup(slot, generation) : nullptr;
+    return entry ? entry->channels : 0;
+}
+
+void TextureHandle::bind(unsigned int unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, id());
+}
+
+// TextureCache
+// ------------------------------------------------------------------------
+TextureCache::TextureCache(std::size_t vramBudgetBytes) : uploader(nullptr), vramBudget(vramBudgetBytes)
+{
+}
+
+TextureCache::~TextureCache()
+{
+    clear();
+}
+
+TextureHandle TextureCache::load(const std::string& path, const TextureOptions& options)
+{
+    const std::string pathKey = canonicalPath(path) + '|' + options.key();
+
+    auto found = byPath.find(pathKey);
+    if (found != byPath.end())
+    {
+        cacheStats.hits++;
+        return acquire(found->second);
+    }
+
+    std::vector<unsigned char> fileBytes;
+    if (!readFile(path, fileBytes))
+    {
+        std::cout << "ERROR::TEXTURE::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+        return TextureHandle();
+    }
+    return create(pathKey, path, fileBytes.data(), fileBytes.size(), false, options);
+}
+
+TextureHandle TextureCache::loadFromMemory(const std::string& name, const unsigned char* data, std::size_t size, const TextureOptions& options)
+{
+    const std::string pathKey = "memory:" + name + '|' + options.key();
+
+    auto found = byPath.find(pathKey);
+    if (found != byPath.end())
+    {
+        cacheStats.hits++;
+        return acquire(found->second);
+    }
+    return create(pathKey, name, data, size, true, options);
+}
+
+bool TextureCache::sameSource(const Entry& entry, const unsigned char* fileBytes, std::size_t fileSize) const
+{
+    if (entry.sourceSize != fileSize)
+        return false;
+    if (entry.sourceData)
+        return std::memcmp(entry.sourceData, fileBytes, fileSize) == 0;
+    std::vector<unsigned char> sourceBytes;
+    return readFile(entry.source, sourceBytes) && sourceBytes.size() == fileSize && std::memcmp(sourceBytes.data(), fileBytes, fileSize) == 0;
+}
+
+TextureHandle TextureCache::create(const std::string& pathKey, const std::string& name, const unsigned char* fileBytes, std::size_t fileSize,
+    bool inMemory, const TextureOptions& options)
+{
+    // hash the encoded bytes first: an identical file under another path (or a copy) is served without decoding it again. The hash
+    // only finds the candidate; the bytes are compared before sharing it, and a collision is decoded as a texture of its own
+    const std::string optionsKey = options.key();
+    const std::uint64_t contentKey = fnv1a64(optionsKey.data(), optionsKey.size(), fnv1a64(fileBytes, fileSize));
+
+    auto sameContent = byContent.find(contentKey);
+    const bool identical = sameContent != byContent.end() && sameSource(entries[sameContent->second], fileBytes, fileSize);
+    if (identical)
+    {
+        cacheStats.contentHits++;
+        entries[sameContent->second].keys.push_back(pathKey);
+        byPath[pathKey] = sameContent->second;
+        return acquire(sameContent->second);
+    }
+
+    cacheStats.misses++;
+
+    int width, height, fileChannels;
+    stbi_set_flip_vertically_on_load(options.flipVertically);
+    unsigned char* data = stbi_load_from_memory(fileBytes, static_cast<int>(fileSize), &width, &height, &fileChannels, options.desiredChannels);
+    if (!data)
+    {
+        std::cout << "ERROR::TEXTURE::DECODE_FAILED: " << name << " (" << stbi_failure_reason() << ")" << std::endl;
+        return TextureHandle();
+    }
+    const int channels = options.desiredChannels ? options.desiredChannels : fileChannels;
+    const GLenum format = formatForChannels(channels);
+
+    // the name is reserved here either way; with an uploader the storage is filled on the loader thread, which frees the pixels
+    unsigned int id;
+    glGenTextures(1, &id);
+    UploadTicket ticket = 0;
+    if (uploader)
+    {
+        ticket = uploader->submit([id, width, height, format, data, options]() {
+            uploadPixels(id, width, height, format, data, options);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            stbi_image_free(data);
+        });
+    }
+    else
+    {
+        uploadPixels(id, width, height, format, data, options);
+        stbi_image_free(data);
+    }
+
+    std::size_t slot;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        slot = entries.size();
+        entries.emplace_back();
+    }
+    Entry& entry = entries[slot];
+    entry.keys.assign(1, pathKey);
+    entry.contentKey = contentKey;
+    entry.source = name;
+    entry.sourceData = inMemory ? fileBytes : nullptr;
+    entry.sourceSize = fileSize;
+    entry.id = id;
+    entry.width = width;
+    entry.height = height;
+    entry.channels = channels;
+    entry.bytes = static_cast<std::size_t>(width) * height * channels;
+    if (options.generateMipmaps)
+        entry.bytes += entry.bytes / 3; // a full mip chain adds about a third
+    entry.refCount = 0;
+    entry.inLru = false;
+    entry.uploaded = ticket == 0;
+    if (ticket)
+        pendingUploads.push_back(PendingUpload{ ticket, slot, entry.generation, id });
+
+    byPath[pathKey] = slot;
+    // on a collision the first texture keeps the content key; this one is still found by its path
+    if (sameContent == byContent.end())
+        byContent[contentKey] = slot;
+    cacheStats.texturesResident++;
+    cacheStats.bytesResident += entry.bytes;
+
+    TextureHandle handle = acquire(slot);
+    enforceBudget();
+    return handle;
+}
+
+void TextureCache::setUploader(UploadThread* newUploader)
+{
+    // tickets belong to the uploader that issued them
+    finishUploads();
+    uploader = newUploader && newUploader->valid() ? newUploader : nullptr;
+}
+
+void TextureCache::poll()
+{
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < pendingUploads.size(); i++)
+    {
+        if (uploader->ready(pendingUploads[i].ticket))
+            completeUpload(pendingUploads[i]);
+        else
+            pendingUploads[kept++] = pendingUploads[i];
+    }
+    pendingUploads.resize(kept);
+}
+
+void TextureCache::finishUploads()
+{
+    for (const PendingUpload& upload : pendingUploads)
+    {
+        uploader->wait(upload.ticket);
+        completeUpload(upload);
+    }
+    pendingUploads.clear();
+}
+
+void TextureCache::completeUpload(const PendingUpload& upload)
+{
+    // an entry evicted mid-upload left its texture for us to delete
+    if (lookup(upload.slot, upload.generation))
+        entries[upload.slot].uploaded = true;
+    else
+        glDeleteTextures(1, &upload.id);
+}
+
+void TextureCache::setBudget(std::size_t vramBudgetBytes)
+{
+    vramBudget = vramBudgetBytes;
+    enforceBudget();
+}
+
+void TextureCache::trim(std::size_t targetBytes)
+{
+    while (cacheStats.bytesResident > targetBytes && !lru.empty())
+        evict(lru.back());
+}
+
+void TextureCache::clear()
+{
+    finishUploads();
+    for (std::size_t slot = 0; slot < entries.size(); slot++)
+    {
+        if (entries[slot].id != 0)
+            evict(slot);
+    }
+}
+
+void TextureCache::resetCounters()
+{
+    cacheStats.hits = 0;
+    cacheStats.contentHits = 0;
+    cacheStats.misses = 0;
+    cacheStats.evictions = 0;
+}
+
+TextureHandle TextureCache::acquire(std::size_t slot)
+{
+    Entry& entry = entries[slot];
+    addRef(slot, entry.generation);
+    return TextureHandle(this, slot, entry.generation);
+}
+
+void TextureCache::addRef(std::size_t slot, std::uint32_t generation)
+{
+    if (!lookup(slot, generation))
+        return;
+    Entry& entry = entries[slot];
+    if (entry.refCount++ == 0 && entry.inLru)
+    {
+        lru.erase(entry.lruIt);
+        entry.inLru = false;
+    }
+}
+
+void TextureCache::release(std::size_t slot, std::uint32_t generation)
+{
+    if (!lookup(slot, generation))
+        return;
+    Entry& entry = entries[slot];
+    if (--entry.refCount == 0)
+    {
+        lru.push_front(slot);
+        entry.lruIt = lru.begin();
+        entry.inLru = true;
+        enforceBudget();
+    }
+}
+
+const TextureCache::Entry* TextureCache::lookup(std::size_t slot, std::uint32_t generation) const
+{
+    if (slot >= entries.size())
+        return nullptr;
+    const Entry& entry = entries[slot];
+    return (entry.id != 0 && entry.generation == generation) ? &entry : nullptr;
+}
+
+void TextureCache::evict(std::size_t slot)
+{
+    Entry& entry = entries[slot];
+    if (entry.uploaded)
+        glDeleteTextures(1, &entry.id);
+    for (const std::string& key : entry.keys)
+        byPath.erase(key);
+    auto sameContent = byContent.find(entry.contentKey);
+    if (sameContent != byContent.end() && sameContent->second == slot)
+        byContent.erase(sameContent);
+    entry.sourceData = nullptr;
+    if (entry.inLru)
+        lru.erase(entry.lruIt);
+
+    cacheStats.evictions++;
+    cacheStats.texturesResident--;
+    cacheStats.bytesResident -= entry.bytes;
+
+    // bump the generation so handles that outlive the entry resolve to nothing instead of a recycled texture
+    std::uint32_t nextGeneration = entry.generation + 1;
+    entry = Entry();
+    entry.generation = nextGeneration;
+    freeSlots.push_back(slot);
+}
+
+void TextureCache::enforceBudget()
+{
+    trim(vramBudget);
+}
@@ -0,0 +1,253 @@
+#include"../include/TlsfAllocator.h"
+
+#include <algorithm>
+
+namespace
+{
+    const std::uint32_t NONE = TlsfAllocation::INVALID;
+
+    int floorLog2(std::uint32_t value)
+    {
+        int log = 0;
+        while (value >>= 1)
+            log++;
+        return log;
+    }
+
+    int lowestBit(std::uint32_t value)
+    {
+        int bit = 0;
+        while (!(value & 1u))
+        {
+            value >>= 1;
+            bit++;
+        }
+        return bit;
+    }
+}
+
+TlsfAllocator::TlsfAllocator(std::uint32_t capacity)
+{
+    reset(capacity);
+}
+
+void TlsfAllocator::reset(std::uint32_t capacity)
+{
+    blocks.clear();
+    unusedBlocks.clear();
+    flBitmap = 0;
+    for (int fl = 0; fl < FL_COUNT; fl++)
+    {
+        slBitmap[fl] = 0;
+        for (int sl = 0; sl < SL_COUNT; sl++)
+            heads[fl][sl] = NONE;
+    }
+    totalSize = capacity;
+    usedSize = 0;
+    allocationCount = 0;
+    // block 0 always starts at offset 0: merges keep the lower block, so it is never recycled
+    std::uint32_t root = newBlock(0, capacity);
+    if (capacity > 0)
+        insertFree(root);
+}
+
+void TlsfAllocator::mapping(std::uint32_t size, int& fl, int& sl)
+{
+    if (size < static_cast<std::uint32_t>(SL_COUNT))
+    {
+        fl = 0;
+        sl = static_cast<int>(size);
+        return;
+    }
+    int log = floorLog2(size);
+    fl = log - SL_BITS + 1;
+    sl = static_cast<int>(size >> (log - SL_BITS)) - SL_COUNT;
+}
+
+std::uint32_t TlsfAllocator::newBlock(std::uint32_t offset, std::uint32_t size)
+{
+    Block block = { offset, size, NONE, NONE, NONE, NONE, true };
+    if (!unusedBlocks.empty())
+    {
+        std::uint32_t node = unusedBlocks.back();
+        unusedBlocks.pop_back();
+        blocks[node] = block;
+        return node;
+    }
+    blocks.push_back(block);
+    return static_cast<std::uint32_t>(blocks.size() - 1);
+}
+
+void TlsfAllocator::insertFree(std::uint32_t node)
+{
+    int fl, sl;
+    mapping(blocks[node].size, fl, sl);
+    blocks[node].free = true;
+    blocks[node].prevFree = NONE;
+    blocks[node].nextFree = heads[fl][sl];
+    if (heads[fl][sl] != NONE)
+        blocks[heads[fl][sl]].prevFree = node;
+    heads[fl][sl] = node;
+    flBitmap |= 1u << fl;
+    slBitmap[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::removeFree(std::uint32_t node)
+{
+    int fl, sl;
+    mapping(blocks[node].size, fl, sl);
+    Block& block = blocks[node];
+    if (block.prevFree != NONE)
+        blocks[block.prevFree].nextFree = block.nextFree;
+    else
+        heads[fl][sl] = block.nextFree;
+    if (block.nextFree != NONE)
+        blocks[block.nextFree].prevFree = block.prevFree;
+    block.prevFree = block.nextFree = NONE;
+    if (heads[fl][sl] == NONE)
+    {
+        slBitmap[fl] &= ~(1u << sl);
+        if (!slBitmap[fl])
+            flBitmap &= ~(1u << fl);
+    }
+}
+
+std::uint32_t TlsfAllocator::findFree(std::uint32_t size) const
+{
+    // round up to the next size class so any block found there is big enough without looking at it
+    std::uint64_t rounded = size;
+    if (size >= static_cast<std::uint32_t>(SL_COUNT))
+        rounded += (1ull << (floorLog2(size) - SL_BITS)) - 1;
+    if (rounded <= 0xFFFFFFFFull)
+    {
+        int fl, sl;
+        mapping(static_cast<std::uint32_t>(rounded), fl, sl);
+        std::uint32_t slMap = slBitmap[fl] & (~0u << sl);
+        if (!slMap && fl + 1 < FL_COUNT)
+        {
+            std::uint32_t flMap = flBitmap & (~0u << (fl + 1));
+            if (flMap)
+            {
+                fl = lowestBit(flMap);
+                slMap = slBitmap[fl];
+            }
+        }
+        if (slMap)
+            return heads[fl][lowestBit(slMap)];
+    }
+    // nearly full: the request's own class may still hold a block that fits exactly
+    int fl, sl;
+    mapping(size, fl, sl);
+    for (std::uint32_t node = heads[fl][sl]; node != NONE; node = blocks[node].nextFree)
+    {
+        if (blocks[node].size >= size)
+            return node;
+    }
+    return NONE;
+}
+
+std::uint32_t TlsfAllocator::splitTail(std::uint32_t node, std::uint32_t keep)
+{
+    std::uint32_t tail = newBlock(blocks[node].offset + keep, blocks[node].size - keep);
+    blocks[tail].prevPhysical = node;
+    blocks[tail].nextPhysical = blocks[node].nextPhysical;
+    if (blocks[node].nextPhysical != NONE)
+        blocks[blocks[node].nextPhysical].prevPhysical = tail;
+    blocks[node].nextPhysical = tail;
+    blocks[node].size = keep;
+    insertFree(tail);
+    return tail;
+}
+
+TlsfAllocation TlsfAllocator::allocate(std::uint32_t size, std::uint32_t alignment)
+{
+    TlsfAllocation allocation;
+    if (size == 0)
+        return allocation;
+    alignment = std::max(alignment, 1u);
+    const std::uint64_t needed = static_cast<std::uint64_t>(size) + alignment - 1;
+    if (needed > 0xFFFFFFFFull)
+        return allocation;
+    std::uint32_t node = findFree(static_cast<std::uint32_t>(needed));
+    if (node == NONE)
+    {
+        // an aligned request might still fit a smaller block that happens to start on the right boundary
+        if (alignment == 1)
+            return allocation;
+        node = findFree(size);
+        if (node == NONE || (alignment - blocks[node].offset % alignment) % alignment + static_cast<std::uint64_t>(size) > blocks[node].size)
+            return allocation;
+    }
+    removeFree(node);
+
+    const std::uint32_t padding = (alignment - blocks[node].offset % alignment) % alignment;
+    if (padding > 0)
+    {
+        // the alignment gap stays behind as a free block of its own
+        std::uint32_t aligned = splitTail(node, padding);
+        removeFree(aligned);
+        insertFree(node);
+        node = aligned;
+    }
+    if (blocks[node].size > size)
+        splitTail(node, size);
+    blocks[node].free = false;
+
+    usedSize += blocks[node].size;
+    allocationCount++;
+    allocation.offset = blocks[node].offset;
+    allocation.size = blocks[node].size;
+    allocation.node = node;
+    return allocation;
+}
+
+void TlsfAllocator::free(const TlsfAllocation& allocation)
+{
+    std::uint32_t node = allocation.node;
+    if (node == NONE || node >= blocks.size() || blocks[node].free)
+        return;
+    usedSize -= blocks[node].size;
+    allocationCount--;
+
+    std::uint32_t next = blocks[node].nextPhysical;
+    if (next != NONE && blocks[next].free)
+    {
+        removeFree(next);
+        blocks[node].size += blocks[next].size;
+        blocks[node].nextPhysical = blocks[next].nextPhysical;
+        if (blocks[next].nextPhysical != NONE)
+            blocks[blocks[next].nextPhysical].prevPhysical = node;
+        unusedBlocks.push_back(next);
+    }
+    std::uint32_t prev = blocks[node].prevPhysical;
+    if (prev != NONE && blocks[prev].free)
+    {
+        removeFree(prev);
+        blocks[prev].size += blocks[node].size;
+        blocks[prev].nextPhysical = blocks[node].nextPhysical;
+        if (blocks[node].nextPhysical != NONE)
+            blocks[blocks[node].nextPhysical].prevPhysical = prev;
+        unusedBlocks.push_back(node);
+        node = prev;
+    }
+    insertFree(node);
+}
+
+TlsfStats TlsfAllocator::stats() const
+{
+    TlsfStats stats;
+    stats.capacity = totalSize;
+    stats.used = usedSize;
+    stats.free = totalSize - usedSize;
+    stats.allocations = allocationCount;
+    if (blocks.empty() || totalSize == 0)
+        return stats;
+    for (std::uint32_t node = 0; node != NONE; node = blocks[node].nextPhysical)
+    {
+        if (!blocks[node].free)
+            continue;
+        stats.freeBlocks++;
+        stats.largestFree = std::max<std::size_t>(stats.largestFree, blocks[node].size);
+    }
+    return stats;
+}
@@ -0,0 +1,440 @@
+#include"../include/TransformKernels.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TRANSFORM_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC lets any function use any intrinsic, the dispatch below keeps them off CPUs without the instructions
+#define TARGET_AVX2
+#else
+#include <cpuid.h>
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace
+{
+    // ---------------------------------------------------------------------------
+    // scalar: the reference every other kernel has to match
+    // ---------------------------------------------------------------------------
+
+    void composeScalar(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, std::size_t count,
+        const glm::mat4* viewProjection, glm::mat4* world, glm::mat4* clip)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const glm::quat& q = rotations[i];
+            const glm::vec3& s = scales[i];
+            const glm::vec3& p = positions[i];
+            const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+            const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+            const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+            glm::mat4& m = world[i];
+            m[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy + wz) * s.x, 2.0f * (xz - wy) * s.x, 0.0f);
+            m[1] = glm::vec4(2.0f * (xy - wz) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz + wx) * s.y, 0.0f);
+            m[2] = glm::vec4(2.0f * (xz + wy) * s.z, 2.0f * (yz - wx) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f);
+            m[3] = glm::vec4(p.x, p.y, p.z, 1.0f);
+            if (clip)
+                clip[i] = *viewProjection * m;
+        }
+    }
+
+#ifdef TRANSFORM_KERNELS_X86
+    // ---------------------------------------------------------------------------
+    // SSE: 4 objects per step. Registers hold one matrix entry for all four; _MM_TRANSPOSE4_PS turns the four entries of a column
+    // back into one column per object.
+    // ---------------------------------------------------------------------------
+
+    struct Entries4
+    {
+        __m128 m[4][4]; // [column][row]
+    };
+
+    void storeColumns4(const Entries4& e, float* out0, float* out1, float* out2, float* out3)
+    {
+        float* outs[4] = { out0, out1, out2, out3 };
+        for (int column = 0; column < 4; column++)
+        {
+            __m128 r0 = e.m[column][0], r1 = e.m[column][1], r2 = e.m[column][2], r3 = e.m[column][3];
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(outs[0] + column * 4, r0);
+            _mm_storeu_ps(outs[1] + column * 4, r1);
+            _mm_storeu_ps(outs[2] + column * 4, r2);
+            _mm_storeu_ps(outs[3] + column * 4, r3);
+        }
+    }
+
+    void composeSse(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, std::size_t count,
+        const glm::mat4* viewProjection, glm::mat4* world, glm::mat4* clip)
+    {
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 zero = _mm_setzero_ps();
+        __m128 vp[4][4];
+        if (clip)
+        {
+            for (int column = 0; column < 4; column++)
+                for (int row = 0; row < 4; row++)
+                    vp[column][row] = _mm_set1_ps((*viewProjection)[column][row]);
+        }
+
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const glm::quat* q = rotations + i;
+            const glm::vec3* s = scales + i;
+            const glm::vec3* p = positions + i;
+            const __m128 qx = _mm_set_ps(q[3].x, q[2].x, q[1].x, q[0].x);
+            const __m128 qy = _mm_set_ps(q[3].y, q[2].y, q[1].y, q[0].y);
+            const __m128 qz = _mm_set_ps(q[3].z, q[2].z, q[1].z, q[0].z);
+            const __m128 qw = _mm_set_ps(q[3].w, q[2].w, q[1].w, q[0].w);
+            const __m128 sx = _mm_set_ps(s[3].x, s[2].x, s[1].x, s[0].x);
+            const __m128 sy = _mm_set_ps(s[3].y, s[2].y, s[1].y, s[0].y);
+            const __m128 sz = _mm_set_ps(s[3].z, s[2].z, s[1].z, s[0].z);
+
+            const __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+            const __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+            const __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+            Entries4 m;
+            m.m[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+            m.m[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+            m.m[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+            m.m[0][3] = zero;
+            m.m[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+            m.m[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+            m.m[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+            m.m[1][3] = zero;
+            m.m[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+            m.m[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+            m.m[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+            m.m[2][3] = zero;
+            m.m[3][0] = _mm_set_ps(p[3].x, p[2].x, p[1].x, p[0].x);
+            m.m[3][1] = _mm_set_ps(p[3].y, p[2].y, p[1].y, p[0].y);
+            m.m[3][2] = _mm_set_ps(p[3].z, p[2].z, p[1].z, p[0].z);
+            m.m[3][3] = one;
+            storeColumns4(m, &world[i][0][0], &world[i + 1][0][0], &world[i + 2][0][0], &world[i + 3][0][0]);
+
+            if (clip)
+            {
+                // the world matrix's bottom row is (0, 0, 0, 1), so each clip column needs three multiply-adds per row, four for the last
+                Entries4 c;
+                for (int column = 0; column < 4; column++)
+                {
+                    for (int row = 0; row < 4; row++)
+                    {
+                        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vp[0][row], m.m[column][0]), _mm_mul_ps(vp[1][row], m.m[column][1])),
+                            _mm_mul_ps(vp[2][row], m.m[column][2]));
+                        c.m[column][row] = column == 3 ? _mm_add_ps(sum, vp[3][row]) : sum;
+                    }
+                }
+                storeColumns4(c, &clip[i][0][0], &clip[i + 1][0][0], &clip[i + 2][0][0], &clip[i + 3][0][0]);
+            }
+        }
+        composeScalar(positions + i, rotations + i, scales + i, count - i, viewProjection, world + i, clip ? clip + i : NULL);
+    }
+
+    // ---------------------------------------------------------------------------
+    // AVX2 + FMA: 8 objects per step. The 4x4 transpose works within each 128-bit half, so one pass yields object k in the low half
+    // and object k + 4 in the high half.
+    // ---------------------------------------------------------------------------
+
+    struct Entries8
+    {
+        __m256 m[4][4]; // [column][row]
+    };
+
+    TARGET_AVX2 void storeColumns8(const Entries8& e, glm::mat4* out)
+    {
+        for (int column = 0; column < 4; column++)
+        {
+            const __m256 t0 = _mm256_unpacklo_ps(e.m[column][0], e.m[column][1]);
+            const __m256 t1 = _mm256_unpackhi_ps(e.m[column][0], e.m[column][1]);
+            const __m256 t2 = _mm256_unpacklo_ps(e.m[column][2], e.m[column][3]);
+            const __m256 t3 = _mm256_unpackhi_ps(e.m[column][2], e.m[column][3]);
+            const __m256 objects[4] = {
+                _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)),
+                _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)),
+                _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+                _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2))
+            };
+            for (int k = 0; k < 4; k++)
+            {
+                _mm_storeu_ps(&out[k][column][0], _mm256_castps256_ps128(objects[k]));
+                _mm_storeu_ps(&out[k + 4][column][0], _mm256_extractf128_ps(objects[k], 1));
+            }
+        }
+    }
+
+    TARGET_AVX2 void composeAvx2(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, std::size_t count,
+        const glm::mat4* viewProjection, glm::mat4* world, glm::mat4* clip)
+    {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m256 zero = _mm256_setzero_ps();
+        // float offsets of the same component in 8 consecutive vec3s / quats
+        const __m256i vec3Stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+        const __m256i quatStride = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+        __m256 vp[4][4];
+        if (clip)
+        {
+            for (int column = 0; column < 4; column++)
+                for (int row = 0; row < 4; row++)
+                    vp[column][row] = _mm256_set1_ps((*viewProjection)[column][row]);
+        }
+
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const glm::quat* q = rotations + i;
+            const glm::vec3* s = scales + i;
+            const glm::vec3* p = positions + i;
+            const float* qf = &q[0].x;
+            const float* sf = &s[0].x;
+            const __m256 qx = _mm256_i32gather_ps(qf, quatStride, 4);
+            const __m256 qy = _mm256_i32gather_ps(qf + 1, quatStride, 4);
+            const __m256 qz = _mm256_i32gather_ps(qf + 2, quatStride, 4);
+            const __m256 qw = _mm256_i32gather_ps(qf + 3, quatStride, 4);
+            const __m256 sx = _mm256_i32gather_ps(sf, vec3Stride, 4);
+            const __m256 sy = _mm256_i32gather_ps(sf + 1, vec3Stride, 4);
+            const __m256 sz = _mm256_i32gather_ps(sf + 2, vec3Stride, 4);
+
+            // doubled quaternion products: 2xx, 2xy, ... so each entry is one add or subtract away
+            const __m256 x2 = _mm256_mul_ps(qx, two), y2 = _mm256_mul_ps(qy, two), z2 = _mm256_mul_ps(qz, two);
+            const __m256 xx = _mm256_mul_ps(qx, x2), yy = _mm256_mul_ps(qy, y2), zz = _mm256_mul_ps(qz, z2);
+            const __m256 xy = _mm256_mul_ps(qx, y2), xz = _mm256_mul_ps(qx, z2), yz = _mm256_mul_ps(qy, z2);
+            const __m256 wx = _mm256_mul_ps(qw, x2), wy = _mm256_mul_ps(qw, y2), wz = _mm256_mul_ps(qw, z2);
+
+            Entries8 m;
+            m.m[0][0] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx);
+            m.m[0][1] = _mm256_mul_ps(_mm256_add_ps(xy, wz), sx);
+            m.m[0][2] = _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx);
+            m.m[0][3] = zero;
+            m.m[1][0] = _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy);
+            m.m[1][1] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy);
+            m.m[1][2] = _mm256_mul_ps(_mm256_add_ps(yz, wx), sy);
+            m.m[1][3] = zero;
+            m.m[2][0] = _mm256_mul_ps(_mm256_add_ps(xz, wy), sz);
+            m.m[2][1] = _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz);
+            m.m[2][2] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz);
+            m.m[2][3] = zero;
+            const float* pf = &p[0].x;
+            m.m[3][0] = _mm256_i32gather_ps(pf, vec3Stride, 4);
+            m.m[3][1] = _mm256_i32gather_ps(pf + 1, vec3Stride, 4);
+            m.m[3][2] = _mm256_i32gather_ps(pf + 2, vec3Stride, 4);
+            m.m[3][3] = one;
+            storeColumns8(m, world + i);
+
+            if (clip)
+            {
+                Entries8 c;
+                for (int column = 0; column < 4; column++)
+                {
+                    for (int row = 0; row < 4; row++)
+                    {
+                        __m256 sum = _mm256_mul_ps(vp[0][row], m.m[column][0]);
+                        sum = _mm256_fmadd_ps(vp[1][row], m.m[column][1], sum);
+                        sum = _mm256_fmadd_ps(vp[2][row], m.m[column][2], sum);
+                        c.m[column][row] = column == 3 ? _mm256_add_ps(sum, vp[3][row]) : sum;
+                    }
+                }
+                storeColumns8(c, clip + i);
+            }
+        }
+        composeSse(positions + i, rotations + i, scales + i, count - i, viewProjection, world + i, clip ? clip + i : NULL);
+    }
+
+    void cpuid(int leaf, int subleaf, unsigned int registers[4])
+    {
+#if defined(_MSC_VER)
+        int values[4];
+        __cpuidex(values, leaf, subleaf);
+        for (int i = 0; i < 4; i++)
+            registers[i] = static_cast<unsigned int>(values[i]);
+#else
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    // XCR0: which register states the OS saves on a context switch
+    unsigned long long readXcr0()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int low, high;
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return (static_cast<unsigned long long>(high) << 32) | low;
+#endif
+    }
+#endif
+
+    transformkernels::Level detectLevel()
+    {
+#ifdef TRANSFORM_KERNELS_X86
+        unsigned int registers[4];
+        cpuid(0, 0, registers);
+        const unsigned int maxLeaf = registers[0];
+        cpuid(1, 0, registers);
+        const bool sse2 = (registers[3] & (1u << 26)) != 0;
+        const bool fma = (registers[2] & (1u << 12)) != 0;
+        const bool osxsave = (registers[2] & (1u << 27)) != 0;
+        const bool avx = (registers[2] & (1u << 28)) != 0;
+        bool avx2 = false;
+        if (maxLeaf >= 7)
+        {
+            cpuid(7, 0, registers);
+            avx2 = (registers[1] & (1u << 5)) != 0;
+        }
+        // the instructions are no use if the OS doesn't preserve the YMM registers (XCR0 bits 1 and 2)
+        if (avx && avx2 && fma && osxsave && (readXcr0() & 6) == 6)
+            return transformkernels::AVX2;
+        if (sse2)
+            return transformkernels::SSE;
+#endif
+        return transformkernels::SCALAR;
+    }
+
+    transformkernels::Level& activeLevel()
+    {
+        static transformkernels::Level level = detectLevel();
+        return level;
+    }
+
+    void dispatch(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, std::size_t count,
+        const glm::mat4* viewProjection, glm::mat4* world, glm::mat4* clip)
+    {
+        switch (activeLevel())
+        {
+#ifdef TRANSFORM_KERNELS_X86
+        case transformkernels::AVX2:
+            composeAvx2(positions, rotations, scales, count, viewProjection, world, clip);
+            return;
+        case transformkernels::SSE:
+            composeSse(positions, rotations, scales, count, viewProjection, world, clip);
+            return;
+#endif
+        default:
+            composeScalar(positions, rotations, scales, count, viewProjection, world, clip);
+            return;
+        }
+    }
+}
+
+transformkernels::Level transformkernels::detect()
+{
+    static const Level detected = detectLevel();
+    return detected;
+}
+
+transformkernels::Level transformkernels::active()
+{
+    return activeLevel();
+}
+
+void transformkernels::setActive(Level level)
+{
+    activeLevel() = std::min(level, detect());
+}
+
+const char* transformkernels::name(Level level)
+{
+    switch (level)
+    {
+    case AVX2: return "AVX2";
+    case SSE: return "SSE";
+    default: return "scalar";
+    }
+}
+
+void transformkernels::compose(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, std::size_t count, glm::mat4* world)
+{
+    dispatch(positions, rotations, scales, count, NULL, world, NULL);
+}
+
+void transformkernels::composeViewProjection(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, std::size_t count,
+    const glm::mat4& viewProjection, glm::mat4* world, glm::mat4* clip)
+{
+    dispatch(positions, rotations, scales, count, &viewProjection, world, clip);
+}
+
+// ---------------------------------------------------------------------------
+// microbenchmark
+// ---------------------------------------------------------------------------
+
+int transformkernels::benchmark(std::size_t count)
+{
+    const int ROUNDS = 20;
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<glm::vec3> positions(count), scales(count);
+    std::vector<glm::quat> rotations(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        positions[i] = glm::vec3(unit(random), unit(random), unit(random)) * 100.0f;
+        scales[i] = glm::vec3(1.5f + unit(random), 1.5f + unit(random), 1.5f + unit(random));
+        rotations[i] = glm::angleAxis(unit(random) * 3.14159265f, glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 2.0f)));
+    }
+    const glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f)
+        * glm::lookAt(glm::vec3(0.0f, 0.0f, 150.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    std::vector<glm::mat4> referenceWorld(count), referenceClip(count), world(count), clip(count);
+    typedef std::chrono::steady_clock Clock;
+    auto nanosecondsPerObject = [&](Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (static_cast<double>(count) * ROUNDS);
+    };
+
+    // the per-object glm path this replaces
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            referenceWorld[i] = glm::translate(glm::mat4(1.0f), positions[i]) * glm::mat4_cast(rotations[i]) * glm::scale(glm::mat4(1.0f), scales[i]);
+            referenceClip[i] = viewProjection * referenceWorld[i];
+        }
+    }
+    std::cout << count << " transforms, world and world * viewProj, " << ROUNDS << " rounds" << std::endl;
+    std::cout << "  glm: " << nanosecondsPerObject(start) << " ns per object" << std::endl;
+
+    const Level previous = active();
+    for (int level = SCALAR; level <= detect(); level++)
+    {
+        setActive(static_cast<Level>(level));
+        start = Clock::now();
+        for (int round = 0; round < ROUNDS; round++)
+            composeViewProjection(positions.data(), rotations.data(), scales.data(), count, viewProjection, world.data(), clip.data());
+        const double time = nanosecondsPerObject(start);
+
+        // relative to each matrix's largest entry, since clip matrices are scaled up by the projection
+        auto difference = [](const glm::mat4& a, const glm::mat4& b) {
+            float largest = 1.0f, worst = 0.0f;
+            for (int column = 0; column < 4; column++)
+            {
+                for (int row = 0; row < 4; row++)
+                {
+                    largest = std::max(largest, std::fabs(b[column][row]));
+                    worst = std::max(worst, std::fabs(a[column][row] - b[column][row]));
+                }
+            }
+            return worst / largest;
+        };
+        float worst = 0.0f;
+        for (std::size_t i = 0; i < count; i++)
+            worst = std::max(worst, std::max(difference(world[i], referenceWorld[i]), difference(clip[i], referenceClip[i])));
+        std::cout << "  " << name(static_cast<Level>(level)) << ": " << time << " ns per object, max relative difference from glm " << worst << std::endl;
+    }
+    setActive(previous);
+    return 0;
+}
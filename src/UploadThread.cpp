@@ -0,0 +1,132 @@
+#include"../include/UploadThread.h"
+
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+
+UploadThread::UploadThread(GLFWwindow* shareWith) : window(NULL), nextTicket(1), outstanding(0), quit(false)
+{
+    // same context version as the window we share with, never shown. Function pointers loaded by glad for the main context are
+    // used as-is on the loader thread, which holds as long as both contexts come from the same driver, as they do here.
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, glfwGetWindowAttrib(shareWith, GLFW_CONTEXT_VERSION_MAJOR));
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, glfwGetWindowAttrib(shareWith, GLFW_CONTEXT_VERSION_MINOR));
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    window = glfwCreateWindow(1, 1, "loader", NULL, shareWith);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (window == NULL)
+    {
+        std::cout << "ERROR::UPLOAD::SHARED_CONTEXT_NOT_CREATED" << std::endl;
+        return;
+    }
+    thread = std::thread(&UploadThread::loaderLoop, this);
+}
+
+UploadThread::~UploadThread()
+{
+    if (window == NULL)
+        return;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        quit = true;
+    }
+    workAvailable.notify_all();
+    thread.join();
+    glfwDestroyWindow(window);
+}
+
+UploadTicket UploadThread::submit(std::function<void()> work)
+{
+    UploadTicket ticket;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        ticket = nextTicket++;
+        queue.push_back(Work{ ticket, std::move(work) });
+        outstanding++;
+    }
+    workAvailable.notify_one();
+    return ticket;
+}
+
+GLsync UploadThread::takeFence(UploadTicket ticket, bool block)
+{
+    std::unique_lock<std::mutex> guard(lock);
+    if (block)
+        workDone.wait(guard, [&]() { return fences.count(ticket) != 0; });
+    auto found = fences.find(ticket);
+    return found != fences.end() ? found->second : NULL;
+}
+
+bool UploadThread::ready(UploadTicket ticket)
+{
+    GLsync fence = takeFence(ticket, false);
+    if (!fence)
+        return false;
+    // a zero timeout only asks; the loader flushed after inserting the fence, so it will signal without our help
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false;
+    if (status == GL_WAIT_FAILED)
+        std::cout << "ERROR::UPLOAD::FENCE_WAIT_FAILED: " << ticket << std::endl;
+    glDeleteSync(fence);
+    std::lock_guard<std::mutex> guard(lock);
+    fences.erase(ticket);
+    outstanding--;
+    return true;
+}
+
+void UploadThread::wait(UploadTicket ticket)
+{
+    GLsync fence = takeFence(ticket, true);
+    const GLuint64 oneSecond = 1000000000;
+    GLenum status;
+    do
+    {
+        status = glClientWaitSync(fence, 0, oneSecond);
+    } while (status == GL_TIMEOUT_EXPIRED);
+    if (status == GL_WAIT_FAILED)
+        std::cout << "ERROR::UPLOAD::FENCE_WAIT_FAILED: " << ticket << std::endl;
+    glDeleteSync(fence);
+    std::lock_guard<std::mutex> guard(lock);
+    fences.erase(ticket);
+    outstanding--;
+}
+
+std::size_t UploadThread::pending() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return outstanding;
+}
+
+void UploadThread::loaderLoop()
+{
+    glfwMakeContextCurrent(window);
+    for (;;)
+    {
+        Work next;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            workAvailable.wait(guard, [this]() { return !queue.empty() || quit; });
+            // drain the queue before quitting: queued work may own memory (decoded pixels) that only it frees
+            if (queue.empty())
+                break;
+            next = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        next.work();
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // without a flush the fence could sit in this context's command queue forever, and waits from the render thread never end
+        glFlush();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            fences[next.ticket] = fence;
+        }
+        workDone.notify_all();
+    }
+
+    // fences nobody collected; sync objects belong to the share group, so deleting them here is as good as anywhere
+    for (auto& fence : fences)
+        glDeleteSync(fence.second);
+    fences.clear();
+    glfwMakeContextCurrent(NULL);
+}
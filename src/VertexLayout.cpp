@@ -0,0 +1,317 @@
+#include"../include/VertexLayout.h"
+#include"../include/MeshFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    struct FormatInfo
+    {
+        GLint components;
+        GLenum type;
+        GLboolean normalized;
+        std::size_t size;
+    };
+
+    FormatInfo formatInfo(VertexFormat format)
+    {
+        switch (format)
+        {
+        case VERTEX_FORMAT_FLOAT2: return FormatInfo{ 2, GL_FLOAT, GL_FALSE, 8 };
+        case VERTEX_FORMAT_FLOAT3: return FormatInfo{ 3, GL_FLOAT, GL_FALSE, 12 };
+        case VERTEX_FORMAT_HALF2: return FormatInfo{ 2, GL_HALF_FLOAT, GL_FALSE, 4 };
+        case VERTEX_FORMAT_HALF4: return FormatInfo{ 3, GL_HALF_FLOAT, GL_FALSE, 8 };
+        case VERTEX_FORMAT_SNORM16X4: return FormatInfo{ 3, GL_SHORT, GL_TRUE, 8 };
+        case VERTEX_FORMAT_UNORM16X2: return FormatInfo{ 2, GL_UNSIGNED_SHORT, GL_TRUE, 4 };
+        // packed formats must be declared with 4 components, the shader just ignores w
+        case VERTEX_FORMAT_SNORM10X3: return FormatInfo{ 4, GL_INT_2_10_10_10_REV, GL_TRUE, 4 };
+        default: return FormatInfo{ 0, GL_FLOAT, GL_FALSE, 0 };
+        }
+    }
+
+    // GL's signed normalized conversion: c / (2^(b-1) - 1), clamped to -1
+    float decodeSnorm(int value, int maxValue)
+    {
+        return std::max(static_cast<float>(value) / maxValue, -1.0f);
+    }
+
+    int encodeSnorm(float value, int maxValue)
+    {
+        return static_cast<int>(std::lround(glm::clamp(value, -1.0f, 1.0f) * maxValue));
+    }
+
+    int encodeUnorm(float value, int maxValue)
+    {
+        return static_cast<int>(std::lround(glm::clamp(value, 0.0f, 1.0f) * maxValue));
+    }
+
+    float roundTripHalf(float value)
+    {
+        return vertexlayout::halfToFloat(vertexlayout::floatToHalf(value));
+    }
+
+    // a zero-width range would turn into a division by zero; any scale reproduces a constant exactly
+    float safeScale(float scale)
+    {
+        return scale > 0.0f ? scale : 1.0f;
+    }
+
+    void put16(unsigned char*& out, std::uint16_t value)
+    {
+        std::memcpy(out, &value, 2);
+        out += 2;
+    }
+
+    void putFloat(unsigned char*& out, float value)
+    {
+        std::memcpy(out, &value, 4);
+        out += 4;
+    }
+}
+
+std::size_t VertexLayout::texCoordOffsetBytes() const
+{
+    return vertexlayout::formatSize(position);
+}
+
+std::size_t VertexLayout::normalOffsetBytes() const
+{
+    return texCoordOffsetBytes() + vertexlayout::formatSize(texCoord);
+}
+
+std::size_t VertexLayout::stride() const
+{
+    return normalOffsetBytes() + vertexlayout::formatSize(normal);
+}
+
+void VertexLayout::apply(unsigned int positionLocation, unsigned int texCoordLocation, unsigned int normalLocation) const
+{
+    const GLsizei vertexStride = static_cast<GLsizei>(stride());
+    const VertexFormat formats[3] = { position, texCoord, normal };
+    const unsigned int locations[3] = { positionLocation, texCoordLocation, normalLocation };
+    const std::size_t offsets[3] = { positionOffsetBytes(), texCoordOffsetBytes(), normalOffsetBytes() };
+    for (int i = 0; i < 3; i++)
+    {
+        if (formats[i] == VERTEX_FORMAT_NONE)
+        {
+            glDisableVertexAttribArray(locations[i]);
+            continue;
+        }
+        FormatInfo info = formatInfo(formats[i]);
+        glVertexAttribPointer(locations[i], info.components, info.type, info.normalized, vertexStride, (void*)offsets[i]);
+        glEnableVertexAttribArray(locations[i]);
+    }
+}
+
+std::uint32_t VertexLayout::packFormats() const
+{
+    return static_cast<std::uint32_t>(position) | (static_cast<std::uint32_t>(texCoord) << 8) | (static_cast<std::uint32_t>(normal) << 16);
+}
+
+void VertexLayout::unpackFormats(std::uint32_t packed)
+{
+    position = static_cast<VertexFormat>(packed & 0xFF);
+    texCoord = static_cast<VertexFormat>((packed >> 8) & 0xFF);
+    normal = static_cast<VertexFormat>((packed >> 16) & 0xFF);
+}
+
+std::size_t vertexlayout::formatSize(VertexFormat format)
+{
+    return formatInfo(format).size;
+}
+
+VertexLayout vertexlayout::full()
+{
+    return VertexLayout();
+}
+
+VertexLayout vertexlayout::choose(const MeshData& mesh, const QuantizationTolerance& tolerance)
+{
+    VertexLayout layout;
+    if (mesh.vertices.empty())
+        return layout;
+
+    // positions: snorm16 around the bounds centre vs raw half floats, both 8 bytes; keep whichever is more accurate if either is good enough
+    const glm::vec3 center = (mesh.boundsMin + mesh.boundsMax) * 0.5f;
+    const glm::vec3 halfExtent = (mesh.boundsMax - mesh.boundsMin) * 0.5f;
+    const glm::vec3 positionScale(safeScale(halfExtent.x), safeScale(halfExtent.y), safeScale(halfExtent.z));
+    float snormError = 0.0f, halfPositionError = 0.0f;
+
+    glm::vec2 uvMin = mesh.vertices[0].texCoord, uvMax = mesh.vertices[0].texCoord;
+    for (const MeshVertex& vertex : mesh.vertices)
+    {
+        uvMin = glm::vec2(std::min(uvMin.x, vertex.texCoord.x), std::min(uvMin.y, vertex.texCoord.y));
+        uvMax = glm::vec2(std::max(uvMax.x, vertex.texCoord.x), std::max(uvMax.y, vertex.texCoord.y));
+    }
+    const glm::vec2 uvScale(safeScale(uvMax.x - uvMin.x), safeScale(uvMax.y - uvMin.y));
+    float unormError = 0.0f, halfTexCoordError = 0.0f, normalError = 0.0f;
+
+    for (const MeshVertex& vertex : mesh.vertices)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            float p = vertex.position[i];
+            float normalized = (p - center[i]) / positionScale[i];
+            float snorm = center[i] + decodeSnorm(encodeSnorm(normalized, 32767), 32767) * positionScale[i];
+            snormError = std::max(snormError, std::fabs(snorm - p));
+            halfPositionError = std::max(halfPositionError, std::fabs(roundTripHalf(p) - p));
+
+            float n = vertex.normal[i];
+            normalError = std::max(normalError, std::fabs(decodeSnorm(encodeSnorm(n, 511), 511) - n));
+        }
+        for (int i = 0; i < 2; i++)
+        {
+            float t = vertex.texCoord[i];
+            float unorm = uvMin[i] + static_cast<float>(encodeUnorm((t - uvMin[i]) / uvScale[i], 65535)) / 65535.0f * uvScale[i];
+            unormError = std::max(unormError, std::fabs(unorm - t));
+            halfTexCoordError = std::max(halfTexCoordError, std::fabs(roundTripHalf(t) - t));
+        }
+    }
+
+    if (std::min(snormError, halfPositionError) <= tolerance.position)
+    {
+        if (snormError <= halfPositionError)
+        {
+            layout.position = VERTEX_FORMAT_SNORM16X4;
+            layout.positionOffset = center;
+            layout.positionScale = positionScale;
+        }
+        else
+        {
+            layout.position = VERTEX_FORMAT_HALF4;
+        }
+    }
+    if (std::min(unormError, halfTexCoordError) <= tolerance.texCoord)
+    {
+        if (unormError <= halfTexCoordError)
+        {
+            layout.texCoord = VERTEX_FORMAT_UNORM16X2;
+            layout.texCoordTransform = glm::vec4(uvMin.x, uvMin.y, uvScale.x, uvScale.y);
+        }
+        else
+        {
+            layout.texCoord = VERTEX_FORMAT_HALF2;
+        }
+    }
+    if (normalError <= tolerance.normal)
+        layout.normal = VERTEX_FORMAT_SNORM10X3;
+    return layout;
+}
+
+void vertexlayout::encode(const MeshData& mesh, const VertexLayout& layout, std::vector<unsigned char>& out)
+{
+    const std::size_t stride = layout.stride();
+    out.assign(mesh.vertices.size() * stride, 0);
+    unsigned char* p = out.data();
+    for (const MeshVertex& vertex : mesh.vertices)
+    {
+        unsigned char* start = p;
+        switch (layout.position)
+        {
+        case VERTEX_FORMAT_SNORM16X4:
+            for (int i = 0; i < 3; i++)
+                put16(p, static_cast<std::uint16_t>(static_cast<std::int16_t>(encodeSnorm((vertex.position[i] - layout.positionOffset[i]) / layout.positionScale[i], 32767))));
+            put16(p, 32767);
+            break;
+        case VERTEX_FORMAT_HALF4:
+            for (int i = 0; i < 3; i++)
+                put16(p, floatToHalf(vertex.position[i]));
+            put16(p, floatToHalf(1.0f));
+            break;
+        default:
+            for (int i = 0; i < 3; i++)
+                putFloat(p, vertex.position[i]);
+            break;
+        }
+        switch (layout.texCoord)
+        {
+        case VERTEX_FORMAT_UNORM16X2:
+            put16(p, static_cast<std::uint16_t>(encodeUnorm((vertex.texCoord.x - layout.texCoordTransform.x) / layout.texCoordTransform.z, 65535)));
+            put16(p, static_cast<std::uint16_t>(encodeUnorm((vertex.texCoord.y - layout.texCoordTransform.y) / layout.texCoordTransform.w, 65535)));
+            break;
+        case VERTEX_FORMAT_HALF2:
+            put16(p, floatToHalf(vertex.texCoord.x));
+            put16(p, floatToHalf(vertex.texCoord.y));
+            break;
+        default:
+            putFloat(p, vertex.texCoord.x);
+            putFloat(p, vertex.texCoord.y);
+            break;
+        }
+        switch (layout.normal)
+        {
+        case VERTEX_FORMAT_SNORM10X3:
+        {
+            std::uint32_t packed = 0;
+            for (int i = 0; i < 3; i++)
+                packed |= (static_cast<std::uint32_t>(encodeSnorm(vertex.normal[i], 511)) & 0x3FFu) << (10 * i);
+            std::memcpy(p, &packed, 4);
+            p += 4;
+            break;
+        }
+        case VERTEX_FORMAT_NONE:
+            break;
+        default:
+            for (int i = 0; i < 3; i++)
+                putFloat(p, vertex.normal[i]);
+            break;
+        }
+        p = start + stride;
+    }
+}
+
+std::uint16_t vertexlayout::floatToHalf(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    const std::uint32_t sign = (bits >> 16) & 0x8000u;
+    const std::uint32_t rawExponent = (bits >> 23) & 0xFFu;
+    std::uint32_t mantissa = bits & 0x7FFFFFu;
+    if (rawExponent == 0xFF)
+        return static_cast<std::uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u)); // inf / nan
+    const int exponent = static_cast<int>(rawExponent) - 127 + 15;
+    if (exponent >= 31)
+        return static_cast<std::uint16_t>(sign | 0x7C00u); // too big, becomes inf
+    if (exponent <= 0)
+    {
+        // subnormal half, or zero if it's too small even for that
+        if (exponent < -10)
+            return static_cast<std::uint16_t>(sign);
+        mantissa |= 0x800000u;
+        const int shift = 14 - exponent;
+        std::uint32_t half = mantissa >> shift;
+        const std::uint32_t rest = mantissa & ((1u << shift) - 1u);
+        const std::uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1u)))
+            half++;
+        return static_cast<std::uint16_t>(sign | half);
+    }
+    std::uint32_t half = (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+    const std::uint32_t rest = mantissa & 0x1FFFu;
+    // round to nearest even; a carry out of the mantissa correctly bumps the exponent
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u)))
+        half++;
+    return static_cast<std::uint16_t>(sign | half);
+}
+
+float vertexlayout::halfToFloat(std::uint16_t half)
+{
+    const std::uint32_t sign = (static_cast<std::uint32_t>(half) & 0x8000u) << 16;
+    const std::uint32_t exponent = (half >> 10) & 0x1Fu;
+    const std::uint32_t mantissa = half & 0x3FFu;
+    std::uint32_t bits;
+    if (exponent == 0)
+    {
+        float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -magnitude : magnitude;
+    }
+    if (exponent == 31)
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    else
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    float value;
+    std::memcpy(&value, &bits, 4);
+    return value;
+}
@@ -4,28 +4,105 @@
 #include"../include/Shader.h"
 #include"../include/Camera.h"
 #include"../include/stb_image.h"
+#include"../include/TextureCache.h"
+#include"../include/TextureArray.h"
+#include"../include/Material.h"
+#include"../include/BindlessTextures.h"
+#include"../include/AssetPack.h"
+#include"../include/Mesh.h"
+#include"../include/LodSelector.h"
+#include"../include/ClusterCuller.h"
+#include"../include/GeometryPool.h"
+#include"../include/JobSystem.h"
+#include"../include/FramePacket.h"
+#include"../include/TripleBuffer.h"
+#include"../include/CommandList.h"
+#include"../include/UploadThread.h"
+#include"../include/FrameArena.h"
+#include"../include/HeapCounter.h"
+#include"../include/EntityStore.h"
+#include"../include/TransformKernels.h"
+#include"../include/InputLog.h"
+#include"../include/CameraPath.h"
+#include"../include/SceneGenerator.h"
+#include"../include/FrameClock.h"
+#include"../include/FramePacer.h"
+#include"../include/DynamicResolution.h"
+#include<algorithm>
+#include<cstdlib>
+#include<cstring>
+#include<memory>
+#include<thread>
+#include<vector>
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
-// camera
-Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+// camera; the eye starts 6 units back (the view used to be translated 3 units further on top of a camera at z = 3)
+Camera camera(glm::vec3(0.0f, 0.0f, 6.0f));
 float lastX = SCR_WIDTH / 2.0f;
 float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
 
+// assets come from the mapped pack when one was given with --pack, loose files otherwise
+AssetPack assetPack;
+
 // timing
 float deltaTime = 0.0f;	// time between current frame and last frame
 float lastFrame = 0.0f;
+// the simulation (camera movement, animation) runs in fixed 60 Hz steps fed by deltaTime, and frames draw a blend of the last two
+// steps. Replays feed it the recorded deltaTimes, so they step exactly like the recorded run did
+FrameClock frameClock;
+std::uint8_t heldKeys = 0; // movement keys sampled by processInput, applied on every step
+double inputSampleTime = 0.0; // glfwGetTime() when processInput last sampled input; latency is measured from here to the swap
+glm::vec3 previousCameraPosition = camera.Position; // where the camera was before the latest step
+// what the frame is drawn from: the simulation camera blended between its last two steps
+Camera renderCamera(camera.Position);
+
+// --record <file> writes every frame's input to a file, --replay <file> plays one back instead of reading the keyboard and mouse
+InputRecorder inputRecorder;
+InputReplay inputReplay;
+InputFrame replayFrame;
+
+// --flythrough <file> moves the camera along an authored path in fixed steps and reports frame times per path segment
+CameraPath cameraPath;
+const float FLYTHROUGH_STEP = 1.0f / 60.0f;
+std::size_t flythroughSegment = 0;
+
+// uniforms set every frame
+constexpr UniformName MODEL_UNIFORM("model");
+constexpr UniformName VIEW_UNIFORM("view");
+constexpr UniformName PROJECTION_UNIFORM("projection");
+constexpr UniformName TRANSFORM_UNIFORM("transform");
+constexpr UniformName POSITION_OFFSET_UNIFORM("positionOffset");
+constexpr UniformName POSITION_SCALE_UNIFORM("positionScale");
+constexpr UniformName TEXCOORD_TRANSFORM_UNIFORM("texCoordTransform");
+constexpr UniformName MATERIAL_IDS_UNIFORM("materialIds");
+
+// the meshes an object can use (EntityStore::meshIds): the built-in cube, and the cooked mesh when --mesh loaded one
+const std::uint32_t SCENE_MESH_CUBE = 0;
+const std::uint32_t SCENE_MESH_LOADED = 1;
+
+// framebuffer size as last reported by GLFW
+int framebufferWidth = SCR_WIDTH;
+int framebufferHeight = SCR_HEIGHT;
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+Shader loadShader(const char* vertexPath, const char* fragmentPath);
+TextureHandle loadTexture(TextureCache& cache, const char* path, const TextureOptions& options);
+int loadLayer(TextureArray& array, const char* path);
+int makePack(const char* outputPath, int fileCount, char* files[]);
+int cookMesh(const char* sourcePath, const char* outputPath);
 
-//callback that gets executed every time the window is resized
+//callback that gets executed every time the window is resized. It runs on the main thread, which may not own the GL context,
+//so it only records the size; the renderer picks it up from the next frame packet and sets the viewport itself (and resizes the
+//dynamic resolution target, whose scaled size is what the scene is actually drawn at).
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    framebufferWidth = width;
+    framebufferHeight = height;
 }
 
 //GLFW's keys
@@ -34,18 +111,164 @@ void processInput(GLFWwindow* window)
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        camera.ProcessKeyboard(FORWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        camera.ProcessKeyboard(BACKWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        camera.ProcessKeyboard(LEFT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        camera.ProcessKeyboard(RIGHT, deltaTime);
+    inputSampleTime = glfwGetTime();
+    std::uint8_t keys = 0;
+    if (!cameraPath.empty())
+    {
+        // the path owns the camera (see interpolateFrame); every frame advances it by the same time, whatever the frame rate
+        if (frameClock.time() > cameraPath.duration())
+            glfwSetWindowShouldClose(window, true);
+        deltaTime = FLYTHROUGH_STEP;
+    }
+    else if (inputReplay.isOpen())
+    {
+        // a replay steps by the recorded deltaTime, not the wall clock, and ends the run when the recording does
+        if (!inputReplay.next(replayFrame))
+        {
+            glfwSetWindowShouldClose(window, true);
+            deltaTime = 0.0f;
+            heldKeys = 0;
+            return;
+        }
+        for (const InputEvent& event : replayFrame.events)
+        {
+            if (event.type == INPUT_MOUSE_MOVE)
+                camera.ProcessMouseMovement(event.x, event.y);
+            else if (event.type == INPUT_SCROLL)
+                camera.ProcessMouseScroll(event.y);
+        }
+        deltaTime = replayFrame.deltaTime;
+        keys = replayFrame.keys;
+    }
+    else
+    {
+        const float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            keys |= INPUT_KEY_FORWARD;
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            keys |= INPUT_KEY_BACKWARD;
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            keys |= INPUT_KEY_LEFT;
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            keys |= INPUT_KEY_RIGHT;
+        inputRecorder.endFrame(deltaTime, keys);
+    }
+    heldKeys = keys;
+}
+
+// one fixed step of the simulation. Mouse look and zoom are applied as their events arrive, so only movement is stepped
+void stepSimulation(float step)
+{
+    previousCameraPosition = camera.Position;
+    if (heldKeys & INPUT_KEY_FORWARD)
+        camera.ProcessKeyboard(FORWARD, step);
+    if (heldKeys & INPUT_KEY_BACKWARD)
+        camera.ProcessKeyboard(BACKWARD, step);
+    if (heldKeys & INPUT_KEY_LEFT)
+        camera.ProcessKeyboard(LEFT, step);
+    if (heldKeys & INPUT_KEY_RIGHT)
+        camera.ProcessKeyboard(RIGHT, step);
+}
+
+// run however many steps this frame's deltaTime pays for
+void advanceSimulation()
+{
+    for (int steps = frameClock.advance(deltaTime); steps > 0; steps--)
+        stepSimulation(static_cast<float>(frameClock.step()));
+}
 
+// set up renderCamera for drawing, between the last two steps; returns the matching animation time. Things that are a function
+// of time (the flythrough path, spinning objects) are simply evaluated at that time rather than blended.
+float interpolateFrame()
+{
+    const float time = static_cast<float>(frameClock.interpolatedTime());
+    if (!cameraPath.empty())
+    {
+        CameraKey key;
+        flythroughSegment = cameraPath.sample(time, key);
+        renderCamera.Position = key.position;
+        renderCamera.SetOrientation(key.yaw, key.pitch);
+        renderCamera.Zoom = key.zoom;
+        return time;
+    }
+    renderCamera.Position = glm::mix(previousCameraPosition, camera.Position, static_cast<float>(frameClock.alpha()));
+    renderCamera.SetOrientation(camera.Yaw, camera.Pitch);
+    renderCamera.Zoom = camera.Zoom;
+    return time;
 }
 
 int main(int argc, char* argv[]) {
+    // command line options
+    // --------------------
+    bool batchedDraws = false; // --batched: draw every cube in one instanced call, materials come from a texture array
+    bool bindlessDraws = false; // --bindless: like --batched, but materials are bindless texture handles (falls back to --batched)
+    const char* meshPath = NULL; // --mesh <file>: draw a cooked .mesh instead of the built-in cube
+    bool pooledGeometry = false; // --pooled: load meshes into one shared GeometryPool instead of a VBO/EBO/VAO each
+    bool singleThreaded = false; // --single-thread: simulate and render on the main thread instead of a separate render thread
+    bool asyncUploads = false; // --async-upload: upload textures from a loader thread with its own shared context
+    std::uint64_t benchmarkFrames = 0; // --benchmark <frames>: run that many frames, then report frame time and heap allocations
+    bool generatedScene = false; // --scene <grid|random|clustered|city> <count>: a generated stress scene instead of the ten cubes
+    scenegen::Settings sceneSettings; // --seed <n> and --dynamic <fraction> tune it
+    FramePacer framePacer; // --present <vsync|adaptive|uncapped|fps>: swap interval and frame rate cap, default vsync
+    bool reportPacing = false;
+    double resolutionTargetMs = 0.0; // --dynamic-resolution <ms>: scale the scene's resolution to keep GPU time near this
+    float resolutionMinScale = 0.5f, resolutionMaxScale = 1.0f; // --resolution-scale <min> <max>: the range it may use
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--batched") == 0)
+            batchedDraws = true;
+        else if (std::strcmp(argv[i], "--bindless") == 0)
+            bindlessDraws = true;
+        else if (std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc)
+            assetPack.open(argv[++i]); // --pack <file>: map an asset pack and load shaders and textures from it
+        else if (std::strcmp(argv[i], "--make-pack") == 0 && i + 1 < argc)
+            return makePack(argv[i + 1], argc - i - 2, argv + i + 2); // --make-pack <out> [files...]: packer tool, runs without a window
+        else if (std::strcmp(argv[i], "--mesh") == 0 && i + 1 < argc)
+            meshPath = argv[++i];
+        else if (std::strcmp(argv[i], "--pooled") == 0)
+            pooledGeometry = true;
+        else if (std::strcmp(argv[i], "--single-thread") == 0)
+            singleThreaded = true;
+        else if (std::strcmp(argv[i], "--async-upload") == 0)
+            asyncUploads = true;
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            inputRecorder.open(argv[++i]);
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            inputReplay.open(argv[++i]);
+        else if (std::strcmp(argv[i], "--flythrough") == 0 && i + 1 < argc)
+            cameraPath.load(argv[++i]);
+        else if (std::strcmp(argv[i], "--scene") == 0 && i + 2 < argc)
+        {
+            generatedScene = scenegen::parseLayout(argv[i + 1], sceneSettings.layout);
+            if (!generatedScene)
+                std::cout << "ERROR::SCENE::UNKNOWN_LAYOUT: " << argv[i + 1] << std::endl;
+            sceneSettings.count = static_cast<std::size_t>(std::atoll(argv[i + 2]));
+            i += 2;
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            sceneSettings.seed = static_cast<std::uint32_t>(std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--dynamic") == 0 && i + 1 < argc)
+            sceneSettings.dynamicFraction = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--present") == 0 && i + 1 < argc)
+            reportPacing = framePacer.parse(argv[++i]);
+        else if (std::strcmp(argv[i], "--dynamic-resolution") == 0 && i + 1 < argc)
+            resolutionTargetMs = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--resolution-scale") == 0 && i + 2 < argc)
+        {
+            resolutionMinScale = static_cast<float>(std::atof(argv[i + 1]));
+            resolutionMaxScale = static_cast<float>(std::atof(argv[i + 2]));
+            i += 2;
+        }
+        else if (std::strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc)
+            benchmarkFrames = static_cast<std::uint64_t>(std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--cook-mesh") == 0 && i + 2 < argc)
+            return cookMesh(argv[i + 1], argv[i + 2]); // --cook-mesh <in.obj> <out.mesh>: mesh cooker, runs without a window
+        else if (std::strcmp(argv[i], "--bench-transforms") == 0) // --bench-transforms [count]: glm vs SIMD world matrices, no window
+            return transformkernels::benchmark(i + 1 < argc ? static_cast<std::size_t>(std::atoi(argv[i + 1])) : 100000);
+    }
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -59,7 +282,18 @@ int main(int argc, char* argv[]) {
     // glfw window creation
     // --------------------
     //straightforward, create a window with x,y dimensions, window title, Monitor(GLFWmointor*) - monitor to use for fullscreen mode or NULL for windowed mode, or and Share(GLFWindow*) - window whose context to share resources with, or NULL to not share resources.
-    GLFWwindow* window = glfwCreateWindow(800, 600, "LearnOpenGL", NULL, NULL);
+    GLFWwindow* window = NULL;
+    if (bindlessDraws)
+    {
+        // ARB_bindless_texture needs GLSL 4.00+, so ask for a 4.5 context and drop back to 3.3 if the driver can't provide one
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        window = glfwCreateWindow(800, 600, "LearnOpenGL", NULL, NULL);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    }
+    if (window == NULL)
+        window = glfwCreateWindow(800, 600, "LearnOpenGL", NULL, NULL);
     if (window == NULL)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -68,6 +302,13 @@ int main(int argc, char* argv[]) {
     }
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);//bind the callback to the window.
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+    // capture the cursor for mouse look, unless a recording or path is driving the camera
+    if (!inputReplay.isOpen() && cameraPath.empty())
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    // the framebuffer can differ from the window size (high-DPI screens), and the callback only reports changes
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
 
     // glad: load all OpenGL function pointers
     // ---------------------------------------
@@ -76,11 +317,28 @@ int main(int argc, char* argv[]) {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    if (bindlessDraws && !bindless::load((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "ARB_bindless_texture not supported, falling back to texture arrays" << std::endl;
+        bindlessDraws = false;
+        batchedDraws = true;
+    }
+    // swapping used to be whatever the driver defaulted to; now it is chosen explicitly
+    framePacer.apply();
+
+    // a hidden second window whose context shares objects with this one; its thread takes the texture uploads off the renderer
+    std::unique_ptr<UploadThread> uploadThread;
+    if (asyncUploads)
+    {
+        uploadThread.reset(new UploadThread(window));
+        if (!uploadThread->valid())
+            uploadThread.reset();
+    }
 
     //set up a viewport. 0,0 sets location of the lower-left corner of the window. Third and Fourth are width and height;
     glViewport(0, 0, 800, 600);
 
-    Shader ourShader("shaders/basic.vs", "shaders/basic.fs");
+    Shader ourShader = loadShader("shaders/basic.vs", "shaders/basic.fs");
 
     //arbitrary vertices
     float vertices[] = {
@@ -162,51 +420,15 @@ int main(int argc, char* argv[]) {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
-    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis. Without this things will appear upside down
-
-    //generate and bind a texture
-    unsigned int texture1,texture2;
-    glGenTextures(1, &texture1);
-    glBindTexture(GL_TEXTURE_2D, texture1);
-    // set the texture wrapping/filtering options (on the currently bound texture object)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load and generate the texture
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load("assets/container.jpg", &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
-    glGenTextures(1, &texture2);
-    glBindTexture(GL_TEXTURE_2D, texture2);
-    // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    data = stbi_load("assets/awesomeface.png", &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        // note that the awesomeface.png has transparency and thus an alpha channel, so make sure to tell OpenGL the data type is of GL_RGBA
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
+    // textures are shared through the cache: loading the same file with the same options again just hands back another handle
+    TextureCache textureCache;
+    textureCache.setUploader(uploadThread.get());
+    TextureOptions containerOptions; // repeat wrapping, trilinear filtering, flipped on load so things don't appear upside down
+    TextureHandle texture1 = loadTexture(textureCache, "assets/container.jpg", containerOptions);
+    TextureOptions faceOptions;
+    faceOptions.minFilter = GL_LINEAR;
+    // note that the awesomeface.png has transparency and thus an alpha channel; the cache picks GL_RGBA from the file's channel count
+    TextureHandle texture2 = loadTexture(textureCache, "assets/awesomeface.png", faceOptions);
 
     //glVertexAttribPointer:
         //param 1: specifies which vertex attribute we want to configure. we get layout location 0, which we've defined as position.
@@ -241,71 +463,520 @@ int main(int argc, char* argv[]) {
     ourShader.setInt("texture1", 0);
     ourShader.setInt("texture2", 1);
 
-    //render loop
-    while (!glfwWindowShouldClose(window))
+    // a cooked mesh replaces the cube geometry above when one was given
+    std::unique_ptr<GeometryPool> geometryPool;
+    std::unique_ptr<Mesh> sceneMesh;
+    if (meshPath)
+    {
+        sceneMesh.reset(new Mesh());
+        if (pooledGeometry)
+            geometryPool.reset(new GeometryPool());
+        if (!(geometryPool ? sceneMesh->load(meshPath, *geometryPool) : sceneMesh->load(meshPath)))
+        {
+            std::cout << "Failed to load mesh, drawing cubes instead" << std::endl;
+            sceneMesh.reset();
+        }
+    }
+
+    // batched path: both textures are layers of one texture array and each cube carries its material as instance data,
+    // so the cubes draw in a single call without rebinding textures between objects.
+    // bindless path: same instance data, but the material "layers" are IDs into a table of resident bindless handles
+    // -------------------------------------------------------------------------------------------
+    std::unique_ptr<Shader> batchedShader;
+    std::unique_ptr<TextureArray> materialArray;
+    std::unique_ptr<BindlessTextureTable> bindlessTable;
+    std::vector<InstanceData> instances;
+    unsigned int instanceVBO = 0;
+    Material crate;
+    crate.detailMix = 0.2f;
+    if (bindlessDraws)
+    {
+        // resident handles are made from the texture names right away, so those have to be filled first
+        textureCache.finishUploads();
+        batchedShader.reset(new Shader(loadShader("shaders/bindless.vs", "shaders/bindless.fs")));
+        bindlessTable.reset(new BindlessTextureTable(texture1));
+        crate.base.layer = static_cast<float>(bindlessTable->addMaterial(texture1));
+        crate.detail.layer = static_cast<float>(bindlessTable->addMaterial(texture2));
+        glUniformBlockBinding(batchedShader->ID, glGetUniformBlockIndex(batchedShader->ID, "MaterialHandles"), 0);
+    }
+    else if (batchedDraws)
+    {
+        batchedShader.reset(new Shader(loadShader("shaders/batched.vs", "shaders/batched.fs")));
+        materialArray.reset(new TextureArray(512, 512, 2));
+        crate.base = materialArray->region(loadLayer(*materialArray, "assets/container.jpg"));
+        crate.detail = materialArray->region(loadLayer(*materialArray, "assets/awesomeface.png"));
+        materialArray->generateMipmaps();
+        batchedShader->use();
+        batchedShader->setInt("materials", 0);
+    }
+    // objects pick one of these by EntityStore::materialIds. Only the batched paths can tell them apart; the per-object path always
+    // draws the two textures with basic.fs's fixed mix
+    std::vector<Material> materials(4, crate);
+    materials[1].detailMix = 0.0f;
+    materials[2].detailMix = 0.6f;
+    std::swap(materials[3].base, materials[3].detail);
+    materials[3].detailMix = 0.3f;
+    if (sceneMesh)
+    {
+        sceneMesh->applyDequantization(ourShader);
+        if (batchedShader)
+            sceneMesh->applyDequantization(*batchedShader);
+    }
+
+    // the scene: one root entity per object, transforms and bounds in structure-of-arrays form. Either the ten cubes, each the
+    // loaded mesh if there is one, or a generated scene mixing the meshes and materials
+    // -------------------------------------------------------------------------------------------
+    EntityStore scene;
+    glm::vec4 meshBounds[2] = { glm::vec4(0.0f, 0.0f, 0.0f, 0.8660254f), glm::vec4(0.0f, 0.0f, 0.0f, 0.8660254f) }; // the unit cube's bounding sphere
+    if (sceneMesh)
     {
-        processInput(window);
+        glm::vec3 center = (sceneMesh->boundsMin() + sceneMesh->boundsMax()) * 0.5f;
+        meshBounds[SCENE_MESH_LOADED] = glm::vec4(center.x, center.y, center.z, glm::length(sceneMesh->boundsMax() - sceneMesh->boundsMin()) * 0.5f);
+    }
+    std::vector<scenegen::Spinner> spinners;
+    if (generatedScene)
+    {
+        sceneSettings.meshCount = sceneMesh ? 2 : 1;
+        sceneSettings.materialCount = static_cast<std::uint32_t>(materials.size());
+        scenegen::generate(sceneSettings, meshBounds, scene, spinners);
+        std::cout << "SCENE: " << scene.size() << " objects, " << scenegen::layoutName(sceneSettings.layout) << " layout, seed "
+            << sceneSettings.seed << ", " << spinners.size() << " dynamic" << std::endl;
+    }
+    else
+    {
+        const std::uint32_t meshId = sceneMesh ? SCENE_MESH_LOADED : SCENE_MESH_CUBE;
+        for (unsigned int i = 0; i < sizeof(cubePositions) / sizeof(cubePositions[0]); i++)
+        {
+            const Entity cube = scene.create();
+            scene.setPosition(cube, cubePositions[i]);
+            scene.setRotation(cube, glm::angleAxis(glm::radians(20.0f * i), glm::normalize(glm::vec3(1.0f, 0.3f, 0.5f))));
+            scene.setLocalBounds(cube, meshBounds[meshId]);
+            scene.meshIds()[scene.row(cube)] = meshId;
+        }
+    }
+
+    // batched paths: room in the instance buffer for every object, in case all of them are visible at once
+    if (batchedShader)
+    {
+        instances.resize(scene.size());
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(sceneMesh ? sceneMesh->vertexArray() : VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+        InstanceData::setupAttributes(2);
+    }
+
+    // each object draws the coarsest LOD whose simplification error stays under a pixel on screen
+    LodSelector lodSelector;
+    // per-object CPU work fans out over every core; this thread joins in while it waits and then does all the GL calls
+    JobSystem jobs;
+    // at full detail a dense mesh is drawn meshlet by meshlet, skipping clusters that are off screen or facing away.
+    // One culler and one command list per recording job, so jobs never share either.
+    const std::size_t OBJECTS_PER_COMMAND_LIST = 64;
+    std::vector<CommandList> commandLists;
+    std::vector<ClusterCuller> listCullers;
+    CommandExecutor commandExecutor;
+    std::vector<InstanceData> lodSorted(instances.size());
+    // scratch for the render thread that only has to last the frame
+    FrameArena renderArena;
+    renderArena.setReportPeaks(benchmarkFrames != 0);
+
+    // simulation: input has already been applied to the camera and the fixed steps run; turn it and the scene into a frame packet
+    // -------------------------------------------------------------------------------------------
+    std::uint64_t frameNumber = 0;
+    std::uint64_t culledCameraVersion = 0;
+    auto simulate = [&](FramePacket& packet) {
+        packet.frame = frameNumber++;
+        packet.time = interpolateFrame();
+        packet.inputTime = inputSampleTime;
+        packet.framebufferWidth = framebufferWidth;
+        packet.framebufferHeight = framebufferHeight;
+
+        // the camera only rebuilds its matrices and frustum when it moved, zoomed or the window changed shape
+        if (framebufferWidth > 0 && framebufferHeight > 0)
+            renderCamera.SetProjection((float)framebufferWidth / (float)framebufferHeight);
+        packet.view = renderCamera.GetViewMatrix();
+        packet.projection = renderCamera.GetProjectionMatrix();
+        packet.frustum = renderCamera.GetFrustum();
+        packet.cameraVersion = renderCamera.GetVersion();
+        packet.fovy = glm::radians(renderCamera.Zoom);
+        packet.eye = renderCamera.Position;
+
+        // world matrices only change for what moved (nothing, for the static cubes), and visibility only when something moved or the
+        // camera did, so a still frame skips culling too. The visible rows are then gathered into the packet in order
+        scenegen::animate(spinners, packet.time, scene);
+        const std::size_t transformsUpdated = scene.updateTransforms(jobs);
+        if (transformsUpdated != 0 || packet.cameraVersion != culledCameraVersion)
+        {
+            jobs.parallelFor(scene.size(), 1024, [&](std::size_t begin, std::size_t end) {
+                scene.cull(packet.frustum, begin, end);
+            });
+            culledCameraVersion = packet.cameraVersion;
+        }
+        const glm::mat4* worlds = scene.worldMatrices();
+        const glm::vec4* bounds = scene.worldBounds();
+        const std::uint8_t* visible = scene.visibility();
+        const std::uint32_t* meshIds = scene.meshIds();
+        const std::uint32_t* materialIds = scene.materialIds();
+        packet.objectCount = scene.indexCount();
+        packet.draws.clear();
+        for (std::size_t row = 0; row < scene.size(); row++) {
+            if (visible[row])
+                packet.draws.push_back(DrawItem{ worlds[row], glm::vec3(bounds[row].x, bounds[row].y, bounds[row].z), scene.entity(row).index, meshIds[row], materialIds[row] });
+        }
+    };
+
+    // the scene goes to an offscreen target sized by GPU time and is upscaled to the window, when asked for
+    std::unique_ptr<DynamicResolution> dynamicResolution;
+    if (resolutionTargetMs > 0.0)
+        dynamicResolution.reset(new DynamicResolution(resolutionTargetMs, resolutionMinScale, resolutionMaxScale));
+
+    // rendering: everything GL, driven only by the packet
+    // -------------------------------------------------------------------------------------------
+    int viewportWidth = 800, viewportHeight = 600;
+    // camera version whose view/projection each program last received; 0 is never a real version
+    std::uint64_t ourShaderCameraVersion = 0, batchedShaderCameraVersion = 0;
+    auto render = [&](const FramePacket& packet) {
+        if (packet.framebufferWidth > 0 && packet.framebufferHeight > 0 && (packet.framebufferWidth != viewportWidth || packet.framebufferHeight != viewportHeight))
+        {
+            viewportWidth = packet.framebufferWidth;
+            viewportHeight = packet.framebufferHeight;
+            glViewport(0, 0, viewportWidth, viewportHeight);
+        }
+
+        renderArena.beginFrame();
+        // textures the loader thread has finished become visible to draws from this frame on
+        textureCache.poll();
+
+        // with dynamic resolution everything up to the upscale in end() draws into the scaled target, and its viewport
+        if (dynamicResolution)
+        {
+            dynamicResolution->setOutputSize(viewportWidth, viewportHeight);
+            dynamicResolution->begin();
+        }
 
         //clear viewport with a greyish colour
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); //clear both pre-existing colours and depth
 
-        // bind textures on corresponding texture units
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
-
         ourShader.use();
 
         //arbitrary vertices
         glm::mat4 model = glm::mat4(1.0f);
-        model = glm::rotate(model, (float)glfwGetTime() * glm::radians(50.0f), glm::vec3(0.5f, 1.0f, 0.0f));
-
-        glm::mat4 view = camera.GetViewMatrix();
-        // note that we're translating the scene in the reverse direction of where we want to move; moving a camera forward is the same as moving the scene back
-        view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
+        model = glm::rotate(model, packet.time * glm::radians(50.0f), glm::vec3(0.5f, 1.0f, 0.0f));
 
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+        const glm::mat4& view = packet.view;
+        const glm::mat4& projection = packet.projection;
+        const glm::vec3& eye = packet.eye;
+        // LOD error is measured in pixels of the target actually drawn to
+        lodSelector.setProjection(packet.fovy, (float)(dynamicResolution ? dynamicResolution->renderHeight() : viewportHeight));
+        const Frustum& frustum = packet.frustum;
 
-        unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        unsigned int viewLoc = glGetUniformLocation(ourShader.ID, "view");
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        ourShader.setMat4("projection", projection);
+        // the names are hashed at compile time and their locations cached by the shader, so none of this builds a string.
+        // Uniforms stay set in the program, so view and projection are only uploaded when the camera has changed
+        ourShader.setMat4(MODEL_UNIFORM, model);
+        if (packet.cameraVersion != ourShaderCameraVersion)
+        {
+            ourShader.setMat4(VIEW_UNIFORM, view);
+            ourShader.setMat4(PROJECTION_UNIFORM, projection);
+            ourShaderCameraVersion = packet.cameraVersion;
+        }
 
         // create transformations
         glm::mat4 transform = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
         transform = glm::translate(transform, glm::vec3(0.5f, -0.5f, 0.0f));
-        transform = glm::rotate(transform, (float)glfwGetTime(), glm::vec3(0.0f, 0.0f, 1.0f));
+        transform = glm::rotate(transform, packet.time, glm::vec3(0.0f, 0.0f, 1.0f));
 
         //get matrix's uniform location and set matrix. Use ourShader.
         ourShader.use();
-        unsigned int transformLoc = glGetUniformLocation(ourShader.ID, "transform");
-        glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(transform));
+        ourShader.setMat4(TRANSFORM_UNIFORM, transform);
 
         glBindVertexArray(VAO);
-        for (unsigned int i = 0; i < 10; i++) {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, cubePositions[i]);
-            float angle = 20.0f * i;
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-            ourShader.setMat4("model", model);
-
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+        if (batchedShader)
+        {
+            const std::size_t drawCount = std::min(packet.draws.size(), instances.size());
+            for (std::size_t i = 0; i < drawCount; i++)
+            {
+                instances[i].model = packet.draws[i].model;
+                instances[i].setMaterial(materials[packet.draws[i].material]);
+            }
+            // group the instances into buckets, one per LOD of the loaded mesh and one for the cubes, so each bucket is one
+            // instanced draw over a contiguous range. Bindless handles must be the same for a whole draw (the extension leaves
+            // sampling through a handle that varies within one undefined), so there each bucket is further split by material
+            const FrameAllocator<int> scratch(renderArena);
+            const std::size_t cubeBucket = sceneMesh ? sceneMesh->lodCount() : 0;
+            const std::size_t materialBuckets = bindlessTable ? materials.size() : 1;
+            FrameVector<int> bucketCounts((cubeBucket + 1) * materialBuckets, 0, scratch);
+            FrameVector<int> instanceBuckets(drawCount, static_cast<int>(cubeBucket), scratch);
+            if (sceneMesh)
+            {
+                for (std::size_t i = 0; i < drawCount; i++)
+                {
+                    if (packet.draws[i].mesh == SCENE_MESH_LOADED)
+                        instanceBuckets[i] = lodSelector.update(packet.draws[i].object, sceneMesh->lods(), packet.draws[i].position, 1.0f, eye);
+                }
+            }
+            if (materialBuckets > 1)
+            {
+                for (std::size_t i = 0; i < drawCount; i++)
+                    instanceBuckets[i] = instanceBuckets[i] * static_cast<int>(materialBuckets) + static_cast<int>(packet.draws[i].material);
+            }
+            FrameVector<int> bucketFirst(bucketCounts.size() + 1, 0, scratch);
+            for (int bucket : instanceBuckets)
+                bucketCounts[bucket]++;
+            for (std::size_t bucket = 0; bucket < bucketCounts.size(); bucket++)
+                bucketFirst[bucket + 1] = bucketFirst[bucket] + bucketCounts[bucket];
+            FrameVector<int> cursor(bucketFirst.begin(), bucketFirst.end() - 1, scratch);
+            for (std::size_t i = 0; i < drawCount; i++)
+                lodSorted[cursor[instanceBuckets[i]]++] = instances[i];
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, drawCount * sizeof(InstanceData), lodSorted.data());
+
+            if (bindlessTable)
+            {
+                bindlessTable->beginFrame();
+                bindlessTable->request(static_cast<int>(crate.base.layer));
+                bindlessTable->request(static_cast<int>(crate.detail.layer));
+                bindlessTable->bind(0);
+            }
+            else
+            {
+                materialArray->bind(0);
+            }
+            batchedShader->use();
+            if (packet.cameraVersion != batchedShaderCameraVersion)
+            {
+                batchedShader->setMat4(VIEW_UNIFORM, view);
+                batchedShader->setMat4(PROJECTION_UNIFORM, projection);
+                batchedShaderCameraVersion = packet.cameraVersion;
+            }
+            for (std::size_t bucket = 0; bucket < bucketCounts.size(); bucket++)
+            {
+                if (bucketCounts[bucket] == 0)
+                    continue;
+                const std::size_t meshBucket = bucket / materialBuckets;
+                if (bindlessTable)
+                {
+                    const Material& material = materials[bucket % materialBuckets];
+                    batchedShader->setVec2(MATERIAL_IDS_UNIFORM, material.base.layer, material.detail.layer);
+                }
+                // the cube's vertices are plain floats, the loaded mesh's quantized, so the dequantization uniforms follow the bucket
+                const VertexLayout& layout = meshBucket == cubeBucket ? VertexLayout() : sceneMesh->layout();
+                if (sceneMesh)
+                {
+                    batchedShader->setVec3(POSITION_OFFSET_UNIFORM, layout.positionOffset);
+                    batchedShader->setVec3(POSITION_SCALE_UNIFORM, layout.positionScale);
+                    batchedShader->setVec4(TEXCOORD_TRANSFORM_UNIFORM, layout.texCoordTransform);
+                }
+                glBindVertexArray(meshBucket == cubeBucket ? VAO : sceneMesh->vertexArray());
+                glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+                InstanceData::setupAttributes(2, bucketFirst[bucket]);
+                if (meshBucket == cubeBucket)
+                    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, bucketCounts[bucket]);
+                else
+                    sceneMesh->drawLodInstanced(meshBucket, bucketCounts[bucket]);
+            }
+        }
+        else
+        {
+            // bind textures on corresponding texture units
+            texture1.bind(0);
+            texture2.bind(1);
+
+            // record the per-object draws into command lists in parallel, a range of objects per list, then replay them in order
+            const GLint modelLocation = ourShader.location(MODEL_UNIFORM);
+            const GLint positionOffsetLocation = ourShader.location(POSITION_OFFSET_UNIFORM);
+            const GLint positionScaleLocation = ourShader.location(POSITION_SCALE_UNIFORM);
+            const GLint texCoordTransformLocation = ourShader.location(TEXCOORD_TRANSFORM_UNIFORM);
+            const std::size_t listCount = (packet.draws.size() + OBJECTS_PER_COMMAND_LIST - 1) / OBJECTS_PER_COMMAND_LIST;
+            if (commandLists.size() < listCount)
+            {
+                commandLists.resize(listCount);
+                listCullers.resize(listCount);
+            }
+            lodSelector.reserve(packet.objectCount);
+            jobs.parallelFor(listCount, 1, [&](std::size_t firstList, std::size_t lastList) {
+                for (std::size_t list = firstList; list < lastList; list++)
+                {
+                    CommandList& commands = commandLists[list];
+                    ClusterCuller& culler = listCullers[list];
+                    commands.reset();
+                    // lists may run in any order relative to what the previous frame left behind, so each sets the dequantization
+                    // uniforms for its first draw and then wherever the mesh changes
+                    std::uint32_t listMesh = 0xFFFFFFFFu;
+                    const std::size_t end = std::min(packet.draws.size(), (list + 1) * OBJECTS_PER_COMMAND_LIST);
+                    for (std::size_t i = list * OBJECTS_PER_COMMAND_LIST; i < end; i++) {
+                        const glm::mat4& model = packet.draws[i].model;
+                        commands.setMat4(modelLocation, model);
+
+                        const std::uint32_t mesh = sceneMesh ? packet.draws[i].mesh : SCENE_MESH_CUBE;
+                        if (sceneMesh && mesh != listMesh)
+                        {
+                            const VertexLayout& layout = mesh == SCENE_MESH_LOADED ? sceneMesh->layout() : VertexLayout();
+                            commands.setVec3(positionOffsetLocation, layout.positionOffset);
+                            commands.setVec3(positionScaleLocation, layout.positionScale);
+                            commands.setVec4(texCoordTransformLocation, layout.texCoordTransform);
+                            listMesh = mesh;
+                        }
+                        if (mesh == SCENE_MESH_LOADED)
+                        {
+                            int lod = lodSelector.update(packet.draws[i].object, sceneMesh->lods(), packet.draws[i].position, 1.0f, eye);
+                            if (lod == 0 && !sceneMesh->meshlets().empty())
+                            {
+                                culler.cull(sceneMesh->meshlets(), model, frustum, eye, sceneMesh->indexSize(), sceneMesh->firstIndex(), sceneMesh->baseVertex());
+                                sceneMesh->recordClusters(commands, culler);
+                            }
+                            else
+                            {
+                                sceneMesh->recordLod(commands, lod);
+                            }
+                        }
+                        else
+                        {
+                            commands.bindVertexArray(VAO);
+                            commands.drawArrays(GL_TRIANGLES, 0, 36);
+                        }
+                    }
+                }
+            });
+            commandExecutor.invalidate();
+            for (std::size_t list = 0; list < listCount; list++)
+                commandExecutor.execute(commandLists[list]);
         }
         //glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
         //glDrawArrays(GL_TRIANGLES, 0, 36);
         //glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
-        //render by swapping buffers
-        glfwPollEvents();
-        glfwSwapBuffers(window);
+        if (dynamicResolution)
+            dynamicResolution->end();
+    };
+
+    // benchmark: the first quarter of the frames is warm-up (caches, arenas and free lists growing to size), the rest is measured
+    const std::uint64_t warmupFrames = benchmarkFrames / 4;
+    std::uint64_t measuredAllocations = 0;
+    double measuredStart = 0.0;
+    auto benchmarkFrame = [&]() {
+        if (benchmarkFrames == 0)
+            return;
+        if (frameNumber == warmupFrames)
+        {
+            measuredAllocations = heapcounter::allocations();
+            measuredStart = glfwGetTime();
+        }
+        if (frameNumber >= benchmarkFrames)
+            glfwSetWindowShouldClose(window, true);
+    };
+
+    // flythrough: each frame's time (start to start) goes to the path segment the camera was in for it
+    CameraPathStats flythroughStats;
+    flythroughStats.reset(cameraPath.segmentCount());
+    double pathFrameStart = 0.0;
+    std::size_t pathFrameSegment = 0, pathFrameDraws = 0;
+    auto flythroughFrame = [&](const FramePacket& packet) {
+        if (cameraPath.empty())
+            return;
+        const double now = glfwGetTime();
+        if (pathFrameStart != 0.0)
+            flythroughStats.addFrame(pathFrameSegment, (now - pathFrameStart) * 1000.0, pathFrameDraws);
+        pathFrameStart = now;
+        pathFrameSegment = flythroughSegment;
+        pathFrameDraws = packet.draws.size();
+    };
+
+    //render loop
+    lastFrame = static_cast<float>(glfwGetTime());
+    if (singleThreaded)
+    {
+        FramePacket packet;
+        while (!glfwWindowShouldClose(window))
+        {
+            // events are polled right before input is sampled, after any frame cap wait, so the frame uses the newest input
+            framePacer.wait();
+            glfwPollEvents();
+            processInput(window);
+            advanceSimulation();
+            simulate(packet);
+            benchmarkFrame();
+            flythroughFrame(packet);
+            render(packet);
+
+            //render by swapping buffers
+            glfwSwapBuffers(window);
+            framePacer.recordSwap(packet.inputTime);
+        }
+    }
+    else
+    {
+        // the render thread owns the context from here on. This thread polls events (GLFW wants that on the main thread) and
+        // simulates frame N+1 while the render thread draws frame N; the two only meet at the triple buffer.
+        TripleBuffer<FramePacket> frames;
+        glfwMakeContextCurrent(NULL);
+        std::thread renderThread([&]() {
+            glfwMakeContextCurrent(window);
+            while (const FramePacket* packet = frames.acquire())
+            {
+                render(*packet);
+                glfwSwapBuffers(window);
+                framePacer.recordSwap(packet->inputTime);
+            }
+            glfwMakeContextCurrent(NULL);
+        });
+        while (!glfwWindowShouldClose(window))
+        {
+            framePacer.wait();
+            glfwPollEvents();
+            processInput(window);
+            advanceSimulation();
+            simulate(frames.writeSlot());
+            benchmarkFrame();
+            flythroughFrame(frames.writeSlot());
+            // stay at most one frame ahead of the renderer
+            frames.waitUntilConsumed();
+            frames.publish();
+        }
+        frames.close();
+        renderThread.join();
+        glfwMakeContextCurrent(window);
+    }
+
+    if (benchmarkFrames != 0 && frameNumber > warmupFrames)
+    {
+        const std::uint64_t measured = frameNumber - warmupFrames;
+        const std::uint64_t allocations = heapcounter::allocations() - measuredAllocations;
+        std::cout << "BENCHMARK: " << scene.size() << " objects (" << spinners.size() << " dynamic), " << measured << " frames, " << (glfwGetTime() - measuredStart) * 1000.0 / measured << " ms/frame, "
+            << allocations << " heap allocations (" << (double)allocations / measured << " per frame), frame arena peak "
+            << renderArena.peak() << " bytes, " << renderArena.overflows() << " overflows" << std::endl;
+    }
+    if (geometryPool)
+        geometryPool->report();
+
+    if (!cameraPath.empty())
+        flythroughStats.report(cameraPath);
+    if (reportPacing || benchmarkFrames != 0)
+        framePacer.report();
+    if (dynamicResolution)
+        dynamicResolution->report();
+    if (inputRecorder.isOpen())
+    {
+        std::cout << "INPUT_LOG: recorded " << inputRecorder.frames() << " frames" << std::endl;
+        inputRecorder.close();
     }
 
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+    if (instanceVBO)
+        glDeleteBuffers(1, &instanceVBO);
+    dynamicResolution.reset();
+    materialArray.reset();
+    sceneMesh.reset();
+    geometryPool.reset();
+    bindlessTable.reset();
+    texture1 = TextureHandle();
+    texture2 = TextureHandle();
+    textureCache.clear();
+    textureCache.setUploader(NULL);
+    uploadThread.reset();
 
     glfwTerminate();
     return 0;
@@ -331,6 +1002,9 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
     lastX = xpos;
     lastY = ypos;
 
+    if (inputReplay.isOpen() || !cameraPath.empty())
+        return; // the recording or the path drives the camera
+    inputRecorder.mouseMove(xoffset, yoffset);
     camera.ProcessMouseMovement(xoffset, yoffset);
 }
 
@@ -338,5 +1012,81 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
 // ----------------------------------------------------------------------
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
+    if (inputReplay.isOpen() || !cameraPath.empty())
+        return;
+    inputRecorder.scroll(static_cast<float>(yoffset));
     camera.ProcessMouseScroll(static_cast<float>(yoffset));
-}
\ No newline at end of file
+}
+
+// asset loading: prefer the mapped pack, whose blobs go to the shader compiler and image decoder without a copy
+// -------------------------------------------------------------------------------------------
+Shader loadShader(const char* vertexPath, const char* fragmentPath)
+{
+    AssetBlob vertex = assetPack.find(vertexPath);
+    AssetBlob fragment = assetPack.find(fragmentPath);
+    if (vertex && fragment)
+        return Shader(vertex.chars(), static_cast<int>(vertex.size), fragment.chars(), static_cast<int>(fragment.size));
+    return Shader(vertexPath, fragmentPath);
+}
+
+TextureHandle loadTexture(TextureCache& cache, const char* path, const TextureOptions& options)
+{
+    AssetBlob blob = assetPack.find(path);
+    if (blob)
+        return cache.loadFromMemory(path, blob.data, blob.size, options);
+    return cache.load(path, options);
+}
+
+int loadLayer(TextureArray& array, const char* path)
+{
+    AssetBlob blob = assetPack.find(path);
+    if (blob)
+        return array.addLayer(path, blob.data, blob.size);
+    return array.addLayer(path);
+}
+
+// packer: write the given files (or every shader and texture the demo uses) into one asset pack
+// -------------------------------------------------------------------------------------------
+int makePack(const char* outputPath, int fileCount, char* files[])
+{
+    const char* defaultFiles[] = {
+        "shaders/basic.vs", "shaders/basic.fs",
+        "shaders/batched.vs", "shaders/batched.fs",
+        "shaders/bindless.vs", "shaders/bindless.fs",
+        "assets/container.jpg", "assets/awesomeface.png", "assets/wall.jpg"
+    };
+    AssetPackWriter writer;
+    if (fileCount > 0)
+    {
+        for (int i = 0; i < fileCount; i++)
+            writer.addFile(files[i]);
+    }
+    else
+    {
+        for (const char* file : defaultFiles)
+            writer.addFile(file);
+    }
+    if (!writer.write(outputPath))
+        return -1;
+    std::cout << "wrote " << outputPath << std::endl;
+    return 0;
+}
+
+// mesh cooker: import an OBJ and write it out in the binary .mesh format the runtime maps and uploads directly
+// -------------------------------------------------------------------------------------------
+int cookMesh(const char* sourcePath, const char* outputPath)
+{
+    MeshData mesh;
+    if (!meshcook::importObj(sourcePath, mesh))
+        return -1;
+    meshcook::generateLods(mesh);
+    meshcook::buildMeshlets(mesh);
+    if (!meshcook::writeMesh(outputPath, mesh))
+        return -1;
+    std::cout << "wrote " << outputPath << ": " << mesh.vertices.size() << " vertices, " << mesh.lods[0].indexCount / 3 << " triangles, "
+        << mesh.lods[0].submeshCount << " submeshes, " << vertexlayout::choose(mesh).stride() << " bytes per vertex (" << sizeof(MeshVertex) << " unquantized)" << std::endl;
+    for (std::size_t i = 1; i < mesh.lods.size(); i++)
+        std::cout << "  LOD " << i << ": " << mesh.lods[i].indexCount / 3 << " triangles, error " << mesh.lods[i].error << std::endl;
+    std::cout << "  " << mesh.meshlets.size() << " meshlets at LOD 0" << std::endl;
+    return 0;
+}